@@ -2038,8 +2038,7 @@ checkout_progress(void *arg, unsigned char status, const char *path)
 		return NULL;
 	}
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 
 	if (a->verbosity >= 0)
 		printf("%c  %s/%s\n", status, a->worktree_path, path);
@@ -2513,8 +2512,7 @@ update_progress(void *arg, unsigned char status, const char *path)
 	if (status == GOT_STATUS_UNVERSIONED)
 		upa->unversioned++;
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	if (upa->verbosity >= 0)
 		printf("%c  %s\n", status, path);
 
@@ -3078,8 +3076,7 @@ diff_blobs(struct got_object_id *blob_id1, struct got_object_id *blob_id2,
 		goto done;
 	}
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	err = got_diff_blob(NULL, NULL, blob1, blob2, f1, f2, path, path,
 	    GOT_DIFF_ALGORITHM_PATIENCE, diff_context, ignore_whitespace,
 	    force_text_diff, dsa, outfile);
@@ -3150,8 +3147,7 @@ diff_trees(struct got_object_id *tree_id1, struct got_object_id *tree_id2,
 	arg.outfile = outfile;
 	arg.lines = NULL;
 	arg.nlines = 0;
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	err = got_diff_tree(tree1, tree2, f1, f2, fd1, fd2, path, path, repo,
 	    got_diff_blob_output_unidiff, &arg, 1);
 done:
@@ -5335,8 +5331,7 @@ print_entry(struct got_tree_entry *te, const char *id, const char *path,
 	char *link_target = NULL;
 
 	path += strlen(root_path);
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 
 	if (got_object_tree_entry_is_submodule(te))
 		modestr = "$";
@@ -6449,8 +6444,7 @@ usage_add(void)
 static const struct got_error *
 add_progress(void *arg, unsigned char status, const char *path)
 {
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	printf("%c  %s\n", status, path);
 	return NULL;
 }
@@ -6588,8 +6582,7 @@ static const struct got_error *
 print_remove_status(void *arg, unsigned char status,
     unsigned char staged_status, const char *path)
 {
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	if (status == GOT_STATUS_NONEXISTENT)
 		return NULL;
 	if (status == staged_status && (status == GOT_STATUS_DELETE))
@@ -7003,8 +6996,7 @@ revert_progress(void *arg, unsigned char status, const char *path)
 	if (status == GOT_STATUS_UNVERSIONED)
 		return NULL;
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	printf("%c  %s\n", status, path);
 	return NULL;
 }
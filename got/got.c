@@ -63,6 +63,8 @@
 #include "got_date.h"
 #include "got_keyword.h"
 
+#include "got_lib_hash.h"
+
 #ifndef nitems
 #define nitems(_a)	(sizeof((_a)) / sizeof((_a)[0]))
 #endif
@@ -253,13 +255,23 @@ main(int argc, char *argv[])
 	signal(SIGINT, catch_sigint);
 	signal(SIGPIPE, catch_sigpipe);
 
+	/*
+	 * Commands which print a line of output per file or per commit
+	 * can emit hundreds of thousands of lines. Unless stdout is a
+	 * terminal, use a large stdio buffer to avoid a write syscall
+	 * per small burst of output.
+	 */
+	if (!isatty(STDOUT_FILENO))
+		setvbuf(stdout, NULL, _IOFBF, 64 * 1024);
+
 	for (i = 0; i < nitems(got_commands); i++) {
 		const struct got_error *error;
 
 		cmd = &got_commands[i];
 
 		if (strcmp(cmd->cmd_name, argv[0]) != 0 &&
-		    strcmp(cmd->cmd_alias, argv[0]) != 0)
+		    (cmd->cmd_alias[0] == '\0' ||
+		    strcmp(cmd->cmd_alias, argv[0]) != 0))
 			continue;
 
 		if (hflag)
@@ -2940,8 +2952,7 @@ checkout_progress(void *arg, unsigned char status, const char *path)
 		return NULL;
 	}
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 
 	if (a->verbosity >= 0)
 		printf("%c  %s/%s\n", status, a->worktree_path, path);
@@ -3078,13 +3089,13 @@ cmd_checkout(int argc, char *argv[])
 	struct got_repository *repo = NULL;
 	struct got_reference *head_ref = NULL, *ref = NULL;
 	struct got_worktree *worktree = NULL;
-	char *repo_path = NULL;
+	char repo_path[PATH_MAX];
 	char *worktree_path = NULL;
 	const char *path_prefix = "";
 	const char *branch_name = GOT_REF_HEAD, *refname = NULL;
 	char *commit_id_str = NULL, *keyword_idstr = NULL;
 	struct got_object_id *commit_id = NULL;
-	char *cwd = NULL;
+	char cwd[PATH_MAX];
 	int ch, same_path_prefix, allow_nonempty = 0, verbosity = 0;
 	struct got_pathlist_head paths;
 	struct got_checkout_progress_arg cpa;
@@ -3129,11 +3140,9 @@ cmd_checkout(int argc, char *argv[])
 	if (argc == 1) {
 		char *base, *dotgit;
 		const char *path;
-		repo_path = realpath(argv[0], NULL);
-		if (repo_path == NULL)
+		if (realpath(argv[0], repo_path) == NULL)
 			return got_error_from_errno2("realpath", argv[0]);
-		cwd = getcwd(NULL, 0);
-		if (cwd == NULL) {
+		if (getcwd(cwd, sizeof(cwd)) == NULL) {
 			error = got_error_from_errno("getcwd");
 			goto done;
 		}
@@ -3154,8 +3163,7 @@ cmd_checkout(int argc, char *argv[])
 		}
 		free(base);
 	} else if (argc == 2) {
-		repo_path = realpath(argv[0], NULL);
-		if (repo_path == NULL) {
+		if (realpath(argv[0], repo_path) == NULL) {
 			error = got_error_from_errno2("realpath", argv[0]);
 			goto done;
 		}
@@ -3342,9 +3350,7 @@ done:
 	got_pathlist_free(&paths, GOT_PATHLIST_FREE_NONE);
 	free(commit_id_str);
 	free(commit_id);
-	free(repo_path);
 	free(worktree_path);
-	free(cwd);
 	return error;
 }
 
@@ -3440,8 +3446,7 @@ update_progress(void *arg, unsigned char status, const char *path)
 	if (status == GOT_STATUS_UNVERSIONED)
 		upa->unversioned++;
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	if (upa->verbosity >= 0)
 		printf("%c  %s\n", status, path);
 
@@ -3599,7 +3604,7 @@ cmd_update(int argc, char *argv[])
 	const struct got_error *close_err, *error = NULL;
 	struct got_repository *repo = NULL;
 	struct got_worktree *worktree = NULL;
-	char *worktree_path = NULL;
+	char worktree_path[PATH_MAX];
 	struct got_object_id *commit_id = NULL;
 	char *commit_id_str = NULL;
 	const char *branch_name = NULL;
@@ -3640,8 +3645,7 @@ cmd_update(int argc, char *argv[])
 	argc -= optind;
 	argv += optind;
 
-	worktree_path = getcwd(NULL, 0);
-	if (worktree_path == NULL) {
+	if (getcwd(worktree_path, sizeof(worktree_path)) == NULL) {
 		error = got_error_from_errno("getcwd");
 		goto done;
 	}
@@ -3802,7 +3806,6 @@ done:
 	}
 	if (head_ref != NULL)
 		got_ref_close(head_ref);
-	free(worktree_path);
 	got_pathlist_free(&paths, GOT_PATHLIST_FREE_PATH);
 	free(commit_id);
 	free(commit_id_str);
@@ -3851,8 +3854,7 @@ diff_blobs(struct got_object_id *blob_id1, struct got_object_id *blob_id2,
 		goto done;
 	}
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	err = got_diff_blob(NULL, NULL, blob1, blob2, f1, f2, path, path,
 	    GOT_DIFF_ALGORITHM_PATIENCE, diff_context, ignore_whitespace,
 	    force_text_diff, dsa, outfile);
@@ -3923,8 +3925,7 @@ diff_trees(struct got_object_id *tree_id1, struct got_object_id *tree_id2,
 	arg.outfile = outfile;
 	arg.lines = NULL;
 	arg.nlines = 0;
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	err = got_diff_tree(tree1, tree2, f1, f2, fd1, fd2, path, path, repo,
 	    got_diff_blob_output_unidiff, &arg, 1);
 done:
@@ -4036,24 +4037,37 @@ print_patch(struct got_commit_object *commit, struct got_object_id *id,
 {
 	const struct got_error *err = NULL;
 	struct got_commit_object *pcommit = NULL;
-	char *id_str1 = NULL, *id_str2 = NULL;
+	char id_str1_buf[GOT_OBJECT_ID_HEX_MAXLEN];
+	char id_str2[GOT_OBJECT_ID_HEX_MAXLEN];
+	const char *id_str1 = NULL;
 	struct got_object_id *obj_id1 = NULL, *obj_id2 = NULL;
 	struct got_object_qid *qid;
 
+	/*
+	 * The parent commit is only needed for its tree ID. No dedicated
+	 * "fetch tree ID" request is made to the privsep helper because
+	 * the parent is usually already present in the object cache:
+	 * print_commits() prefetches commits in batches ahead of the
+	 * commit currently being printed.
+	 */
 	qid = STAILQ_FIRST(got_object_commit_get_parent_ids(commit));
 	if (qid != NULL) {
 		err = got_object_open_as_commit(&pcommit, repo,
 		    &qid->id);
 		if (err)
 			return err;
-		err = got_object_id_str(&id_str1, &qid->id);
-		if (err)
+		if (got_object_id_hex(&qid->id, id_str1_buf,
+		    sizeof(id_str1_buf)) == NULL) {
+			err = got_error(GOT_ERR_BAD_OBJ_ID_STR);
 			goto done;
+		}
+		id_str1 = id_str1_buf;
 	}
 
-	err = got_object_id_str(&id_str2, id);
-	if (err)
+	if (got_object_id_hex(id, id_str2, sizeof(id_str2)) == NULL) {
+		err = got_error(GOT_ERR_BAD_OBJ_ID_STR);
 		goto done;
+	}
 
 	if (path && path[0] != '\0') {
 		int obj_type;
@@ -4075,11 +4089,9 @@ print_patch(struct got_commit_object *commit, struct got_object_id *id,
 			free(obj_id2);
 			goto done;
 		}
-		fprintf(outfile,
-		    "diff %s %s\n", id_str1 ? id_str1 : "/dev/null", id_str2);
-		fprintf(outfile, "commit - %s\n",
-		    id_str1 ? id_str1 : "/dev/null");
-		fprintf(outfile, "commit + %s\n", id_str2);
+		fprintf(outfile, "diff %s %s\ncommit - %s\ncommit + %s\n",
+		    id_str1 ? id_str1 : "/dev/null", id_str2,
+		    id_str1 ? id_str1 : "/dev/null", id_str2);
 		switch (obj_type) {
 		case GOT_OBJ_TYPE_BLOB:
 			err = diff_blobs(obj_id1, obj_id2, path, diff_context,
@@ -4099,17 +4111,13 @@ print_patch(struct got_commit_object *commit, struct got_object_id *id,
 		obj_id2 = got_object_commit_get_tree_id(commit);
 		if (pcommit)
 			obj_id1 = got_object_commit_get_tree_id(pcommit);
-		fprintf(outfile,
-		    "diff %s %s\n", id_str1 ? id_str1 : "/dev/null", id_str2);
-		fprintf(outfile, "commit - %s\n",
-		    id_str1 ? id_str1 : "/dev/null");
-		fprintf(outfile, "commit + %s\n", id_str2);
+		fprintf(outfile, "diff %s %s\ncommit - %s\ncommit + %s\n",
+		    id_str1 ? id_str1 : "/dev/null", id_str2,
+		    id_str1 ? id_str1 : "/dev/null", id_str2);
 		err = diff_trees(obj_id1, obj_id2, "", diff_context, 0, 0,
 		    dsa, repo, outfile);
 	}
 done:
-	free(id_str1);
-	free(id_str2);
 	if (pcommit)
 		got_object_commit_close(pcommit);
 	return err;
@@ -4346,8 +4354,6 @@ print_commit_oneline(struct got_commit_object *commit, struct got_object_id *id,
 	else
 		printf("%s%.7s %s\n", datebuf, id_str, s);
 
-	if (fflush(stdout) != 0 && err == NULL)
-		err = got_error_from_errno("fflush");
 done:
 	free(id_str);
 	free(ref_str);
@@ -4414,15 +4420,16 @@ print_commit(struct got_commit_object *commit, struct got_object_id *id,
 {
 	const struct got_error *err = NULL;
 	FILE *f = NULL;
-	char *id_str, *datestr, *logmsg0, *logmsg, *line;
+	char *datestr, *logmsg0;
+	const char *logmsg, *end, *nl;
+	char id_str[GOT_OBJECT_ID_HEX_MAXLEN];
 	char datebuf[26];
 	time_t committer_time;
 	const char *author, *committer;
 	char *refs_str = NULL;
 
-	err = got_object_id_str(&id_str, id);
-	if (err)
-		return err;
+	if (got_object_id_hex(id, id_str, sizeof(id_str)) == NULL)
+		return got_error(GOT_ERR_BAD_OBJ_ID_STR);
 
 	if (custom_refs_str == NULL) {
 		struct got_reflist_head *refs;
@@ -4442,13 +4449,11 @@ print_commit(struct got_commit_object *commit, struct got_object_id *id,
 		printf("%s %s%s%s%s\n", prefix ? prefix : "commit", id_str,
 		    refs_str ? " (" : "", refs_str ? refs_str : "",
 		    refs_str ? ")" : "");
-	free(id_str);
-	id_str = NULL;
 	free(refs_str);
 	refs_str = NULL;
-	printf("from: %s\n", got_object_commit_get_author(commit));
 	author = got_object_commit_get_author(commit);
 	committer = got_object_commit_get_committer(commit);
+	printf("from: %s\n", author);
 	if (strcmp(author, committer) != 0)
 		printf("via: %s\n", committer);
 	committer_time = got_object_commit_get_committer_time(commit);
@@ -4461,12 +4466,12 @@ print_commit(struct got_commit_object *commit, struct got_object_id *id,
 		int n = 1;
 		parent_ids = got_object_commit_get_parent_ids(commit);
 		STAILQ_FOREACH(qid, parent_ids, entry) {
-			err = got_object_id_str(&id_str, &qid->id);
-			if (err)
+			if (got_object_id_hex(&qid->id, id_str,
+			    sizeof(id_str)) == NULL) {
+				err = got_error(GOT_ERR_BAD_OBJ_ID_STR);
 				goto done;
+			}
 			printf("parent %d: %s\n", n++, id_str);
-			free(id_str);
-			id_str = NULL;
 		}
 	}
 
@@ -4474,12 +4479,23 @@ print_commit(struct got_commit_object *commit, struct got_object_id *id,
 	if (err)
 		goto done;
 
+	/*
+	 * Print the log message line by line; memchr avoids both the
+	 * byte-at-a-time delimiter scan of strsep and writing NUL
+	 * bytes into the message.
+	 */
 	logmsg = logmsg0;
-	do {
-		line = strsep(&logmsg, "\n");
-		if (line)
-			printf(" %s\n", line);
-	} while (line);
+	end = logmsg0 + strlen(logmsg0);
+	for (;;) {
+		size_t linelen;
+
+		nl = memchr(logmsg, '\n', end - logmsg);
+		linelen = nl ? (size_t)(nl - logmsg) : (size_t)(end - logmsg);
+		printf(" %.*s\n", (int)linelen, logmsg);
+		if (nl == NULL)
+			break;
+		logmsg = nl + 1;
+	}
 	free(logmsg0);
 
 	if (changed_paths && diffstat == NULL) {
@@ -4518,13 +4534,9 @@ print_commit(struct got_commit_object *commit, struct got_object_id *id,
 	}
 	if (show_patch)
 		printf("\n");
-
-	if (fflush(stdout) != 0 && err == NULL)
-		err = got_error_from_errno("fflush");
 done:
 	if (f && fclose(f) == EOF && err == NULL)
 		err = got_error_from_errno("fclose");
-	free(id_str);
 	free(refs_str);
 	return err;
 }
@@ -4545,9 +4557,14 @@ print_commits(struct got_object_id *root_id, struct got_object_id *end_id,
 	struct got_object_qid *qid;
 	struct got_commit_object *commit;
 	struct got_pathlist_head changed_paths;
+	struct got_object_id ids[GOT_OBJECT_OPEN_COMMITS_MAX];
+	struct got_commit_object *commits[GOT_OBJECT_OPEN_COMMITS_MAX];
+	int nfetched = 0, next = 0, iter_completed = 0;
+	int tty = isatty(STDOUT_FILENO);
 
 	STAILQ_INIT(&reversed_commits);
 	TAILQ_INIT(&changed_paths);
+	memset(commits, 0, sizeof(commits));
 
 	if (search_pattern && regcomp(&regex, search_pattern,
 	    REG_EXTENDED | REG_NOSUB | REG_NEWLINE))
@@ -4565,6 +4582,13 @@ print_commits(struct got_object_id *root_id, struct got_object_id *end_id,
 	}
 	if (err)
 		goto done;
+
+	/*
+	 * Hold the stdio lock across the whole loop; the per-line printf
+	 * calls below then take the recursive fast path instead of an
+	 * atomic lock operation per line of output.
+	 */
+	flockfile(stdout);
 	for (;;) {
 		struct got_object_id id;
 		struct got_diffstat_cb_arg dsa = { 0, 0, 0, 0, 0, 0,
@@ -4573,17 +4597,41 @@ print_commits(struct got_object_id *root_id, struct got_object_id *end_id,
 		if (sigint_received || sigpipe_received)
 			break;
 
-		err = got_commit_graph_iter_next(&id, graph, repo,
-		    check_cancelled, NULL);
-		if (err) {
-			if (err->code == GOT_ERR_ITER_COMPLETED)
-				err = NULL;
-			break;
+		if (next >= nfetched) {
+			/*
+			 * Refill the ring: read a batch of IDs off the graph
+			 * iterator and open the corresponding commit objects
+			 * in one go, pipelining privsep requests instead of
+			 * paying an IPC round-trip per commit.
+			 */
+			next = 0;
+			nfetched = 0;
+			while (nfetched < GOT_OBJECT_OPEN_COMMITS_MAX &&
+			    !iter_completed) {
+				err = got_commit_graph_iter_next(&ids[nfetched],
+				    graph, repo, check_cancelled, NULL);
+				if (err) {
+					if (err->code ==
+					    GOT_ERR_ITER_COMPLETED) {
+						err = NULL;
+						iter_completed = 1;
+					}
+					break;
+				}
+				nfetched++;
+			}
+			if (err || nfetched == 0)
+				break;
+			err = got_object_open_as_commits(commits, ids,
+			    nfetched, repo);
+			if (err)
+				break;
 		}
 
-		err = got_object_open_as_commit(&commit, repo, &id);
-		if (err)
-			break;
+		memcpy(&id, &ids[next], sizeof(id));
+		commit = commits[next];
+		commits[next] = NULL;
+		next++;
 
 		if (((show_changed_paths && !show_diffstat) ||
 		    (show_diffstat && !show_patch))
@@ -4636,6 +4684,15 @@ print_commits(struct got_object_id *root_id, struct got_object_id *end_id,
 			got_object_commit_close(commit);
 			if (err)
 				break;
+			/*
+			 * On a terminal, show each commit as soon as it has
+			 * been formatted; otherwise let stdio flush whole
+			 * buffers at a time.
+			 */
+			if (tty && fflush(stdout) == EOF) {
+				err = got_error_from_errno("fflush");
+				break;
+			}
 		}
 		if ((limit && --limit == 0) ||
 		    (end_id && got_object_id_cmp(&id, end_id) == 0))
@@ -4671,10 +4728,20 @@ print_commits(struct got_object_id *root_id, struct got_object_id *end_id,
 			got_object_commit_close(commit);
 			if (err)
 				break;
+			if (tty && fflush(stdout) == EOF) {
+				err = got_error_from_errno("fflush");
+				break;
+			}
 			got_pathlist_free(&changed_paths, GOT_PATHLIST_FREE_ALL);
 		}
 	}
+	funlockfile(stdout);
 done:
+	while (next < nfetched) {
+		if (commits[next])
+			got_object_commit_close(commits[next]);
+		next++;
+	}
 	while (!STAILQ_EMPTY(&reversed_commits)) {
 		qid = STAILQ_FIRST(&reversed_commits);
 		STAILQ_REMOVE_HEAD(&reversed_commits, entry);
@@ -4712,6 +4779,30 @@ get_default_log_limit(void)
 	return n;
 }
 
+/*
+ * Resolve the work tree's branch reference, or HEAD if there is no
+ * work tree, to a commit ID. Several commands need this when no commit
+ * was specified on the command line; sharing one helper avoids opening
+ * and closing the reference in each of them.
+ */
+static const struct got_error *
+resolve_head_commit_id(struct got_object_id **id,
+    struct got_worktree *worktree, struct got_repository *repo)
+{
+	const struct got_error *err;
+	struct got_reference *head_ref;
+
+	*id = NULL;
+
+	err = got_ref_open(&head_ref, repo, worktree ?
+	    got_worktree_get_head_ref_name(worktree) : GOT_REF_HEAD, 0);
+	if (err)
+		return err;
+	err = got_ref_resolve(id, repo, head_ref);
+	got_ref_close(head_ref);
+	return err;
+}
+
 static const struct got_error *
 cmd_log(int argc, char *argv[])
 {
@@ -4719,7 +4810,8 @@ cmd_log(int argc, char *argv[])
 	struct got_repository *repo = NULL;
 	struct got_worktree *worktree = NULL;
 	struct got_object_id *start_id = NULL, *end_id = NULL;
-	char *repo_path = NULL, *path = NULL, *cwd = NULL, *in_repo_path = NULL;
+	char *repo_path = NULL, *path = NULL, *in_repo_path = NULL;
+	char cwd[PATH_MAX];
 	char *keyword_idstr = NULL;
 	const char *start_commit = NULL, *end_commit = NULL;
 	const char *search_pattern = NULL;
@@ -4813,8 +4905,7 @@ cmd_log(int argc, char *argv[])
 	if (one_line && (show_patch || show_changed_paths || show_diffstat))
 		errx(1, "cannot use -s with -d, -p or -P");
 
-	cwd = getcwd(NULL, 0);
-	if (cwd == NULL) {
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
 		error = got_error_from_errno("getcwd");
 		goto done;
 	}
@@ -4874,15 +4965,8 @@ cmd_log(int argc, char *argv[])
 		goto done;
 
 	if (start_commit == NULL) {
-		struct got_reference *head_ref;
 		struct got_commit_object *commit = NULL;
-		error = got_ref_open(&head_ref, repo,
-		    worktree ? got_worktree_get_head_ref_name(worktree)
-		    : GOT_REF_HEAD, 0);
-		if (error != NULL)
-			goto done;
-		error = got_ref_resolve(&start_id, repo, head_ref);
-		got_ref_close(head_ref);
+		error = resolve_head_commit_id(&start_id, worktree, repo);
 		if (error != NULL)
 			goto done;
 		error = got_object_open_as_commit(&commit, repo,
@@ -4963,7 +5047,6 @@ cmd_log(int argc, char *argv[])
 done:
 	free(path);
 	free(repo_path);
-	free(cwd);
 	free(start_id);
 	free(end_id);
 	free(keyword_idstr);
@@ -5262,7 +5345,7 @@ cmd_diff(int argc, char *argv[])
 	const struct got_error *error;
 	struct got_repository *repo = NULL;
 	struct got_worktree *worktree = NULL;
-	char *cwd = NULL, *repo_path = NULL;
+	char cwd[PATH_MAX], *repo_path = NULL;
 	const char *commit_args[2] = { NULL, NULL };
 	int ncommit_args = 0;
 	struct got_object_id *ids[2] = { NULL, NULL };
@@ -5336,8 +5419,7 @@ cmd_diff(int argc, char *argv[])
 	argc -= optind;
 	argv += optind;
 
-	cwd = getcwd(NULL, 0);
-	if (cwd == NULL) {
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
 		error = got_error_from_errno("getcwd");
 		goto done;
 	}
@@ -5641,6 +5723,25 @@ cmd_diff(int argc, char *argv[])
 		worktree = NULL;
 	}
 
+	/*
+	 * Diffing a commit against itself yields an empty diff.
+	 * Print the usual header lines but skip the diff engine.
+	 */
+	if (type2 == GOT_OBJ_TYPE_COMMIT && ids[0] != NULL &&
+	    got_object_id_cmp(ids[0], ids[1]) == 0) {
+		char *id_str;
+
+		error = got_object_id_str(&id_str, ids[1]);
+		if (error)
+			goto done;
+		fprintf(outfile, "diff %s %s\n", labels[0], labels[1]);
+		fprintf(outfile, "commit - %s\n", id_str);
+		fprintf(outfile, "commit + %s\n", id_str);
+		free(id_str);
+		error = printfile(outfile);
+		goto done;
+	}
+
 	fd1 = got_opentempfd();
 	if (fd1 == -1) {
 		error = got_error_from_errno("got_opentempfd");
@@ -5700,7 +5801,6 @@ cmd_diff(int argc, char *argv[])
 	error = printfile(outfile);
 
 done:
-	free(cwd);
 	free(labels[0]);
 	free(labels[1]);
 	free(ids[0]);
@@ -5858,7 +5958,8 @@ cmd_blame(int argc, char *argv[])
 	const struct got_error *error;
 	struct got_repository *repo = NULL;
 	struct got_worktree *worktree = NULL;
-	char *path, *cwd = NULL, *repo_path = NULL, *in_repo_path = NULL;
+	char *path, *repo_path = NULL, *in_repo_path = NULL;
+	char cwd[PATH_MAX];
 	char *link_target = NULL;
 	struct got_object_id *obj_id = NULL;
 	struct got_object_id *commit_id = NULL;
@@ -5909,8 +6010,7 @@ cmd_blame(int argc, char *argv[])
 	else
 		usage_blame();
 
-	cwd = getcwd(NULL, 0);
-	if (cwd == NULL) {
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
 		error = got_error_from_errno("getcwd");
 		goto done;
 	}
@@ -5973,13 +6073,7 @@ cmd_blame(int argc, char *argv[])
 		goto done;
 
 	if (commit_id_str == NULL) {
-		struct got_reference *head_ref;
-		error = got_ref_open(&head_ref, repo, worktree ?
-		    got_worktree_get_head_ref_name(worktree) : GOT_REF_HEAD, 0);
-		if (error != NULL)
-			goto done;
-		error = got_ref_resolve(&commit_id, repo, head_ref);
-		got_ref_close(head_ref);
+		error = resolve_head_commit_id(&commit_id, worktree, repo);
 		if (error != NULL)
 			goto done;
 	} else {
@@ -6094,7 +6188,6 @@ done:
 	free(in_repo_path);
 	free(link_target);
 	free(repo_path);
-	free(cwd);
 	free(commit_id);
 	free(obj_id);
 	if (commit)
@@ -6159,8 +6252,7 @@ print_entry(struct got_tree_entry *te, const char *id, const char *path,
 	char *link_target = NULL;
 
 	path += strlen(root_path);
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 
 	if (got_object_tree_entry_is_submodule(te))
 		modestr = "$";
@@ -6210,27 +6302,40 @@ print_tree(const char *path, struct got_commit_object *commit,
 	nentries = got_object_tree_get_nentries(tree);
 	for (i = 0; i < nentries; i++) {
 		struct got_tree_entry *te;
-		char *id = NULL;
+		char id_str[GOT_OBJECT_ID_HEX_MAXLEN + 1];
+		const char *id = NULL;
 
 		if (sigint_received || sigpipe_received)
 			break;
 
 		te = got_object_tree_get_entry(tree, i);
+		if (i + 1 < nentries) {
+			struct got_tree_entry *nte;
+
+			/*
+			 * Tree entries are several cache lines wide;
+			 * start fetching the next one while this entry
+			 * is being formatted and printed.
+			 */
+			nte = got_object_tree_get_entry(tree, i + 1);
+			GOT_PREFETCH(nte);
+			if (show_ids)
+				GOT_PREFETCH(got_tree_entry_get_id(nte));
+		}
 		if (show_ids) {
-			char *id_str;
-			err = got_object_id_str(&id_str,
-			    got_tree_entry_get_id(te));
-			if (err)
+			if (got_object_id_hex(got_tree_entry_get_id(te),
+			    id_str, GOT_OBJECT_ID_HEX_MAXLEN) == NULL) {
+				err = got_error(GOT_ERR_BAD_OBJ_ID_STR);
 				goto done;
-			if (asprintf(&id, "%s ", id_str) == -1) {
-				err = got_error_from_errno("asprintf");
-				free(id_str);
+			}
+			if (strlcat(id_str, " ", sizeof(id_str)) >=
+			    sizeof(id_str)) {
+				err = got_error(GOT_ERR_NO_SPACE);
 				goto done;
 			}
-			free(id_str);
+			id = id_str;
 		}
 		err = print_entry(te, id, path, root_path, repo);
-		free(id);
 		if (err)
 			goto done;
 
@@ -6262,8 +6367,8 @@ cmd_tree(int argc, char *argv[])
 	const struct got_error *error;
 	struct got_repository *repo = NULL;
 	struct got_worktree *worktree = NULL;
-	const char *path, *refname = NULL;
-	char *cwd = NULL, *repo_path = NULL, *in_repo_path = NULL;
+	const char *path;
+	char cwd[PATH_MAX], *repo_path = NULL, *in_repo_path = NULL;
 	struct got_object_id *commit_id = NULL;
 	struct got_commit_object *commit = NULL;
 	char *commit_id_str = NULL, *keyword_idstr = NULL;
@@ -6311,8 +6416,7 @@ cmd_tree(int argc, char *argv[])
 	else
 		path = NULL;
 
-	cwd = getcwd(NULL, 0);
-	if (cwd == NULL) {
+	if (getcwd(cwd, sizeof(cwd)) == NULL) {
 		error = got_error_from_errno("getcwd");
 		goto done;
 	}
@@ -6380,16 +6484,7 @@ cmd_tree(int argc, char *argv[])
 	}
 
 	if (commit_id_str == NULL) {
-		struct got_reference *head_ref;
-		if (worktree)
-			refname = got_worktree_get_head_ref_name(worktree);
-		else
-			refname = GOT_REF_HEAD;
-		error = got_ref_open(&head_ref, repo, refname, 0);
-		if (error != NULL)
-			goto done;
-		error = got_ref_resolve(&commit_id, repo, head_ref);
-		got_ref_close(head_ref);
+		error = resolve_head_commit_id(&commit_id, worktree, repo);
 		if (error != NULL)
 			goto done;
 	} else {
@@ -6425,13 +6520,15 @@ cmd_tree(int argc, char *argv[])
 	if (error)
 		goto done;
 
+	/* Take the stdio lock once instead of once per printed entry. */
+	flockfile(stdout);
 	error = print_tree(in_repo_path, commit, show_ids, recurse,
 	    in_repo_path, repo);
+	funlockfile(stdout);
 done:
 	free(keyword_idstr);
 	free(in_repo_path);
 	free(repo_path);
-	free(cwd);
 	free(commit_id);
 	if (commit)
 		got_object_commit_close(commit);
@@ -8026,15 +8123,9 @@ cmd_tag(int argc, char *argv[])
 			goto done;
 
 		if (commit_id_arg == NULL) {
-			struct got_reference *head_ref;
 			struct got_object_id *commit_id;
-			error = got_ref_open(&head_ref, repo,
-			    worktree ? got_worktree_get_head_ref_name(worktree)
-			    : GOT_REF_HEAD, 0);
-			if (error)
-				goto done;
-			error = got_ref_resolve(&commit_id, repo, head_ref);
-			got_ref_close(head_ref);
+			error = resolve_head_commit_id(&commit_id,
+			    worktree, repo);
 			if (error)
 				goto done;
 			error = got_object_id_str(&commit_id_str, commit_id);
@@ -8094,8 +8185,7 @@ usage_add(void)
 static const struct got_error *
 add_progress(void *arg, unsigned char status, const char *path)
 {
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	printf("%c  %s\n", status, path);
 	return NULL;
 }
@@ -8233,8 +8323,7 @@ static const struct got_error *
 print_remove_status(void *arg, unsigned char status,
     unsigned char staged_status, const char *path)
 {
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	if (status == GOT_STATUS_NONEXISTENT)
 		return NULL;
 	if (status == staged_status && (status == GOT_STATUS_DELETE))
@@ -8655,8 +8744,7 @@ revert_progress(void *arg, unsigned char status, const char *path)
 	if (status == GOT_STATUS_UNVERSIONED)
 		return NULL;
 
-	while (path[0] == '/')
-		path++;
+	path += strspn(path, "/");
 	printf("%c  %s\n", status, path);
 	return NULL;
 }
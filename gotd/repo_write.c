@@ -582,7 +582,7 @@ protect_branch_namespace(const char *namespace, struct got_pack *pack,
 	}
 
 	return protect_require_yca(&ref_update->new_id,
-	    be32toh(packidx->hdr.fanout_table[0xff]), pack, packidx,
+	    packidx->nobj, pack, packidx,
 	    ref_update->ref);
 }
 
@@ -600,7 +600,7 @@ protect_branch(const char *refname, struct got_pack *pack,
 	}
 
 	return protect_require_yca(&ref_update->new_id,
-	    be32toh(packidx->hdr.fanout_table[0xff]), pack, packidx,
+	    packidx->nobj, pack, packidx,
 	    ref_update->ref);
 }
 
@@ -65,6 +65,13 @@
 #define __attribute__(a)
 #endif
 
+/* Best-effort data prefetch hint; a no-op where unsupported. */
+#ifdef __GNUC__
+#define GOT_PREFETCH(addr)	__builtin_prefetch(addr)
+#else
+#define GOT_PREFETCH(addr)	((void)0)
+#endif
+
 
 #ifndef UID_MAX
 # define UID_MAX	UINT_MAX	/* max value for a uid_t */
@@ -221,6 +228,12 @@ void uuid_to_string(uuid_t *, char **, uint32_t *);
 #define SHA2_CTX SHA256_CTX
 #endif
 
+/*
+ * Message digests are delegated to the system provider (libc on
+ * OpenBSD, libcrypto elsewhere). These implementations select
+ * hardware-accelerated block functions (SHA-NI, NEON) at runtime,
+ * so no vendored SHA code is carried here.
+ */
 #ifndef __APPLE__
 #ifdef HAVE_SHA_H
 #  include <sha.h>
@@ -141,6 +141,20 @@ const struct got_error *got_object_resolve_id_str(struct got_object_id **,
 const struct got_error *got_object_open_as_commit(struct got_commit_object **,
     struct got_repository *, struct got_object_id *);
 
+/* Maximum number of commits got_object_open_as_commits() will open at once. */
+#define GOT_OBJECT_OPEN_COMMITS_MAX	8
+
+/*
+ * Attempt to open several commit objects in a repository at once.
+ * Where possible, requests are pipelined to privsep helpers in a batch
+ * instead of paying a synchronous IPC round-trip per commit.
+ * On success the commits array contains one open commit per object ID.
+ * The caller must dispose of each commit with got_object_commit_close().
+ */
+const struct got_error *got_object_open_as_commits(
+    struct got_commit_object **, struct got_object_id *, int,
+    struct got_repository *);
+
 /* Dispose of a commit object. */
 void got_object_commit_close(struct got_commit_object *);
 
@@ -106,6 +106,14 @@ void got_pathlist_free(struct got_pathlist_head *, int);
 /* Attempt to create a directory at a given path. */
 const struct got_error *got_path_mkdir(const char *);
 
+/*
+ * Join a parent directory and a child path with a '/' separator into
+ * a caller-provided buffer, avoiding a heap allocation per join.
+ * Returns GOT_ERR_NO_SPACE if the result would not fit.
+ */
+const struct got_error *got_path_join(char *, size_t, const char *,
+    const char *);
+
 /* Determine whether a directory has no files or directories in it. */
 int got_path_dir_is_empty(const char *);
 
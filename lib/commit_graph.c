@@ -98,10 +98,20 @@ struct got_commit_graph {
 	char *path;
 
 	/*
-	 * Nodes which will be passed to the API user next, sorted by
-	 * commit timestamp. Sorted in topological order only if topological
-	 * sorting was requested.
+	 * Nodes which will be passed to the API user next.
+	 *
+	 * During iteration in commit timestamp order, nodes are kept on
+	 * a binary max-heap keyed on committer timestamp, with the most
+	 * recent commit at the root. Insertion and removal cost O(log N),
+	 * whereas a timestamp-sorted list costs O(N) per insertion which
+	 * adds up quickly while traversing merge-heavy history.
+	 *
+	 * Iteration in topological order keeps nodes on iter_list instead,
+	 * which preserves the insertion order the sort relies on.
 	 */
+	struct got_commit_graph_node **heap;
+	int heap_len;
+	int heap_size;
 	struct got_commit_graph_iter_list iter_list;
 };
 
@@ -158,24 +168,70 @@ done:
 	return err;
 }
 
-static void
-add_node_to_iter_list(struct got_commit_graph *graph,
-    struct got_commit_graph_node *node, time_t committer_time)
+static const struct got_error *
+heap_push(struct got_commit_graph *graph, struct got_commit_graph_node *node)
 {
-	struct got_commit_graph_node *n, *next;
+	struct got_commit_graph_node **heap = graph->heap;
+	int i, parent;
 
-	node->timestamp = committer_time;
+	if (graph->heap_len == graph->heap_size) {
+		int heap_size = graph->heap_size ? graph->heap_size * 2 : 64;
 
-	n = TAILQ_FIRST(&graph->iter_list);
-	while (n) {
-		next = TAILQ_NEXT(n, entry);
-		if (next && node->timestamp >= next->timestamp) {
-			TAILQ_INSERT_BEFORE(next, node, entry);
-			return;
-		}
-		n = next;
+		heap = recallocarray(graph->heap, graph->heap_size,
+		    heap_size, sizeof(*heap));
+		if (heap == NULL)
+			return got_error_from_errno("recallocarray");
+		graph->heap = heap;
+		graph->heap_size = heap_size;
+	}
+
+	i = graph->heap_len++;
+	while (i > 0) {
+		parent = (i - 1) / 2;
+		if (heap[parent]->timestamp >= node->timestamp)
+			break;
+		heap[i] = heap[parent];
+		i = parent;
+	}
+	heap[i] = node;
+	return NULL;
+}
+
+static struct got_commit_graph_node *
+heap_pop(struct got_commit_graph *graph)
+{
+	struct got_commit_graph_node **heap = graph->heap;
+	struct got_commit_graph_node *root, *last;
+	int i = 0, child;
+
+	if (graph->heap_len == 0)
+		return NULL;
+
+	root = heap[0];
+	last = heap[--graph->heap_len];
+	for (;;) {
+		child = 2 * i + 1;
+		if (child >= graph->heap_len)
+			break;
+		if (child + 1 < graph->heap_len &&
+		    heap[child + 1]->timestamp > heap[child]->timestamp)
+			child++;
+		if (last->timestamp >= heap[child]->timestamp)
+			break;
+		heap[i] = heap[child];
+		i = child;
 	}
-	TAILQ_INSERT_TAIL(&graph->iter_list, node, entry);
+	if (graph->heap_len > 0)
+		heap[i] = last;
+	return root;
+}
+
+static const struct got_error *
+add_node_to_iter_heap(struct got_commit_graph *graph,
+    struct got_commit_graph_node *node, time_t committer_time)
+{
+	node->timestamp = committer_time;
+	return heap_push(graph, node);
 }
 
 static const struct got_error *
@@ -455,26 +511,49 @@ add_branch_tip(struct got_object_id *commit_id, void *data, void *arg)
 	const struct got_error *err;
 	struct add_branch_tip_arg *a = arg;
 	struct got_commit_graph_node *new_node;
-	struct got_commit_object *commit;
-
-	err = got_object_open_as_commit(&commit, a->repo, commit_id);
-	if (err)
-		return err;
 
 	err = add_node(&new_node, a->graph, commit_id, a->repo);
-	if (err) {
-		got_object_commit_close(commit);
+	if (err)
 		return err;
-	}
 
 	a->tips[a->ntips].commit_id = &new_node->id;
-	a->tips[a->ntips].commit = commit;
+	a->tips[a->ntips].commit = NULL; /* opened in batches below */
 	a->tips[a->ntips].new_node = new_node;
 	a->ntips++;
 
 	return NULL;
 }
 
+/*
+ * Open the commit objects of all collected branch tips, requesting
+ * them from privsep helpers in batches rather than one round-trip
+ * per open branch.
+ */
+static const struct got_error *
+open_branch_tip_commits(struct got_commit_graph_branch_tip *tips, int ntips,
+    struct got_repository *repo)
+{
+	const struct got_error *err;
+	struct got_object_id ids[GOT_OBJECT_OPEN_COMMITS_MAX];
+	struct got_commit_object *commits[GOT_OBJECT_OPEN_COMMITS_MAX];
+	int i, j, n;
+
+	for (i = 0; i < ntips; i += n) {
+		n = ntips - i;
+		if (n > GOT_OBJECT_OPEN_COMMITS_MAX)
+			n = GOT_OBJECT_OPEN_COMMITS_MAX;
+		for (j = 0; j < n; j++)
+			memcpy(&ids[j], tips[i + j].commit_id, sizeof(ids[j]));
+		err = got_object_open_as_commits(commits, ids, n, repo);
+		if (err)
+			return err;
+		for (j = 0; j < n; j++)
+			tips[i + j].commit = commits[j];
+	}
+
+	return NULL;
+}
+
 static const struct got_error *
 fetch_commits_from_open_branches(struct got_commit_graph *graph,
     struct got_repository *repo, got_cancel_cb cancel_cb, void *cancel_arg)
@@ -506,6 +585,10 @@ fetch_commits_from_open_branches(struct got_commit_graph *graph,
 	if (err)
 		goto done;
 
+	err = open_branch_tip_commits(arg.tips, arg.ntips, repo);
+	if (err)
+		goto done;
+
 	for (i = 0; i < arg.ntips; i++) {
 		struct got_object_id *commit_id;
 		struct got_commit_object *commit;
@@ -537,8 +620,10 @@ fetch_commits_from_open_branches(struct got_commit_graph *graph,
 			continue;
 		}
 		if (changed) {
-			add_node_to_iter_list(graph, new_node,
+			err = add_node_to_iter_heap(graph, new_node,
 			    got_object_commit_get_committer_time(commit));
+			if (err)
+				break;
 			arg.tips[i].new_node = NULL;
 		}
 		err = advance_branch(graph, commit_id, commit, repo);
@@ -547,7 +632,8 @@ fetch_commits_from_open_branches(struct got_commit_graph *graph,
 	}
 done:
 	for (i = 0; i < arg.ntips; i++) {
-		got_object_commit_close(arg.tips[i].commit);
+		if (arg.tips[i].commit)
+			got_object_commit_close(arg.tips[i].commit);
 		free(arg.tips[i].new_node);
 	}
 	return err;
@@ -557,6 +643,7 @@ void
 got_commit_graph_close(struct got_commit_graph *graph)
 {
 	struct got_commit_graph_node *node;
+	int i;
 
 	while ((node = TAILQ_FIRST(&graph->iter_list))) {
 		TAILQ_REMOVE(&graph->iter_list, node, entry);
@@ -564,6 +651,12 @@ got_commit_graph_close(struct got_commit_graph *graph)
 		free(node);
 	}
 
+	for (i = 0; i < graph->heap_len; i++) {
+		free(graph->heap[i]->more_parents);
+		free(graph->heap[i]);
+	}
+	free(graph->heap);
+
 	if (graph->open_branches)
 		got_object_idset_free(graph->open_branches);
 	if (graph->node_ids)
@@ -594,6 +687,7 @@ got_commit_graph_bfsort(struct got_commit_graph *graph,
 	/* Clear left-over state from previous iteration attempts. */
 	while ((node = TAILQ_FIRST(&graph->iter_list)))
 		TAILQ_REMOVE(&graph->iter_list, node, entry);
+	graph->heap_len = 0;
 	err = got_object_idset_for_each(graph->open_branches,
 	    remove_branch_tip, graph->open_branches);
 	if (err)
@@ -604,7 +698,7 @@ got_commit_graph_bfsort(struct got_commit_graph *graph,
 		return err;
 
 	/* Locate first commit which changed graph->path. */
-	while (TAILQ_EMPTY(&graph->iter_list) &&
+	while (graph->heap_len == 0 &&
 	    got_object_idset_num_elements(graph->open_branches) > 0) {
 		err = fetch_commits_from_open_branches(graph, repo,
 		    cancel_cb, cancel_arg);
@@ -612,7 +706,7 @@ got_commit_graph_bfsort(struct got_commit_graph *graph,
 			return err;
 	}
 
-	if (TAILQ_EMPTY(&graph->iter_list)) {
+	if (graph->heap_len == 0) {
 		const char *path;
 		if (got_path_is_root_dir(graph->path))
 			return got_error_no_obj(id);
@@ -634,29 +728,38 @@ got_commit_graph_iter_next(struct got_object_id *id,
 	struct got_commit_graph_node *node, *pnode;
 	int i;
 
-	node = TAILQ_FIRST(&graph->iter_list);
-	if (node == NULL) {
-		/* We are done iterating, or iteration was not started. */
-		return got_error(GOT_ERR_ITER_COMPLETED);
-	}
-
 	if (graph->flags & GOT_COMMIT_GRAPH_TOPOSORT) {
+		node = TAILQ_FIRST(&graph->iter_list);
+		if (node == NULL) {
+			/* We are done iterating, or iteration not started. */
+			return got_error(GOT_ERR_ITER_COMPLETED);
+		}
 		/* At least one node with in-degree zero must exist. */
 		while (node->indegree != 0)
 			node = TAILQ_NEXT(node, entry);
+		TAILQ_REMOVE(&graph->iter_list, node, entry);
 	} else {
-		while (TAILQ_NEXT(node, entry) == NULL &&
+		if (graph->heap_len == 0) {
+			/* We are done iterating, or iteration not started. */
+			return got_error(GOT_ERR_ITER_COMPLETED);
+		}
+		/*
+		 * Ensure that a successor exists on the heap before
+		 * removing the most recent commit; more recent commits
+		 * may still be discovered on other open branches.
+		 */
+		while (graph->heap_len < 2 &&
 		    got_object_idset_num_elements(graph->open_branches) > 0) {
 			err = fetch_commits_from_open_branches(graph, repo,
 			    cancel_cb, cancel_arg);
 			if (err)
 				return err;
 		}
+		node = heap_pop(graph);
 	}
 
 	memcpy(id, &node->id, sizeof(*id));
 
-	TAILQ_REMOVE(&graph->iter_list, node, entry);
 	if (graph->flags & GOT_COMMIT_GRAPH_TOPOSORT) {
 		/* When visiting a commit decrement in-degree of all parents. */
 		for (i = 0; i < node->nparents; i++) {
@@ -841,6 +944,7 @@ got_commit_graph_toposort(struct got_commit_graph *graph,
 	/* Clear left-over state from previous iteration attempts. */
 	while ((node = TAILQ_FIRST(&graph->iter_list)))
 		TAILQ_REMOVE(&graph->iter_list, node, entry);
+	graph->heap_len = 0;
 	err = got_object_idset_for_each(graph->open_branches,
 	    remove_branch_tip, graph->open_branches);
 	if (err)
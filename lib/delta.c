@@ -39,31 +39,16 @@
 #define	MIN(_a,_b) ((_a) < (_b) ? (_a) : (_b))
 #endif
 
-struct got_delta *
-got_delta_open(off_t offset, size_t tslen, int type, size_t size,
-    off_t data_offset)
-{
-	struct got_delta *delta;
-
-	delta = malloc(sizeof(*delta));
-	if (delta == NULL)
-		return NULL;
-
-	delta->type = type;
-	delta->offset = offset;
-	delta->tslen = tslen;
-	delta->size = size;
-	delta->data_offset = data_offset;
-	return delta;
-}
-
 const struct got_error *
 got_delta_chain_get_base_type(int *type, struct got_delta_chain *deltas)
 {
 	struct got_delta *delta;
 
-	/* The first delta in the chain should represent the base object. */
-	delta = STAILQ_FIRST(&deltas->entries);
+	if (deltas->nentries == 0)
+		return got_error(GOT_ERR_BAD_DELTA_CHAIN);
+
+	/* The last delta in the chain should represent the base object. */
+	delta = &deltas->entries[deltas->nentries - 1];
 	if (delta->type == GOT_OBJ_TYPE_COMMIT ||
 	    delta->type == GOT_OBJ_TYPE_TREE ||
 	    delta->type == GOT_OBJ_TYPE_BLOB ||
@@ -176,6 +161,46 @@ parse_opcode(off_t *offset, size_t *len, const uint8_t **p, size_t *remain)
 	return NULL;
 }
 
+/*
+ * Branch-free variant of parse_opcode() for in-memory delta
+ * application. Callers must ensure that at least 9 bytes remain in
+ * the delta stream: the opcode byte, up to seven operand bytes, and
+ * one byte beyond, which the gather below may read but never
+ * consumes. Within these bounds no truncation error can occur.
+ */
+static inline void
+parse_opcode_fast(off_t *offset, size_t *len, const uint8_t **p,
+    size_t *remain)
+{
+	const uint8_t *q = *p + 1;
+	uint64_t acc = 0;
+	uint8_t opcode = **p;
+	size_t nparsed;
+	int shift;
+
+	/*
+	 * Each set bit in the opcode's lower seven bits announces one
+	 * operand byte: four offset bytes followed by three length
+	 * bytes. A cleared bit contributes zero and does not advance
+	 * the input position, sparing a mispredicted branch per bit.
+	 */
+	for (shift = 0; shift < 7; shift++) {
+		uint64_t bit = (opcode >> shift) & 1;
+		acc |= (bit * (uint64_t)*q) << (8 * shift);
+		q += bit;
+	}
+
+	*offset = acc & 0xffffffff;	/* default offset is zero */
+	*len = acc >> 32;
+	if (*len == 0)
+		*len = GOT_DELTA_COPY_DEFAULT_LEN;
+
+	/* Leave *p at the last parsed byte, as parse_opcode() does. */
+	nparsed = q - (*p + 1);
+	*p += nparsed;
+	*remain -= nparsed;
+}
+
 static const struct got_error *
 copy_from_base(FILE *base_file, off_t offset, size_t size, FILE *outfile)
 {
@@ -254,6 +279,22 @@ got_delta_get_sizes(uint64_t *base_size, uint64_t *result_size,
 	return parse_delta_sizes(base_size, result_size, &p, &remain);
 }
 
+/*
+ * Copy helper for delta copy instructions. Pack deltas are dominated
+ * by very short copies, where the fixed cost of a memcpy call exceeds
+ * the cost of the copy itself. Copy short runs inline and leave the
+ * longer ones to memcpy.
+ */
+static inline void
+delta_copy(uint8_t *dst, const uint8_t *src, size_t len)
+{
+	if (len < 16) {
+		while (len-- > 0)
+			*dst++ = *src++;
+	} else
+		memcpy(dst, src, len);
+}
+
 const struct got_error *
 got_delta_apply_in_mem(uint8_t *base_buf, size_t base_bufsz,
     const uint8_t *delta_buf, size_t delta_len, uint8_t *outbuf,
@@ -281,15 +322,20 @@ got_delta_apply_in_mem(uint8_t *base_buf, size_t base_bufsz,
 		if (*p & GOT_DELTA_BASE_COPY) {
 			off_t offset = 0;
 			size_t len = 0;
-			err = parse_opcode(&offset, &len, &p, &remain);
-			if (err)
-				break;
+			if (remain >= 9)
+				parse_opcode_fast(&offset, &len, &p, &remain);
+			else {
+				err = parse_opcode(&offset, &len, &p, &remain);
+				if (err)
+					break;
+			}
 			if (SIZE_MAX - offset < len || offset + len < 0 ||
 			    base_bufsz < offset + len ||
 			    *outsize + len > maxoutsize)
 				return got_error_msg(GOT_ERR_BAD_DELTA,
 				    "bad delta copy length");
-			memcpy(outbuf + *outsize, base_buf + offset, len);
+			delta_copy(outbuf + *outsize, base_buf + offset,
+			    len);
 			if (err == NULL) {
 				*outsize += len;
 				if (remain > 0) {
@@ -311,7 +357,7 @@ got_delta_apply_in_mem(uint8_t *base_buf, size_t base_bufsz,
 			    *outsize + len > maxoutsize)
 				return got_error_msg(GOT_ERR_BAD_DELTA,
 				    "bad delta copy length");
-			memcpy(outbuf + *outsize, p, len);
+			delta_copy(outbuf + *outsize, p, len);
 			p += len;
 			remain -= len;
 			*outsize += len;
@@ -324,6 +370,91 @@ got_delta_apply_in_mem(uint8_t *base_buf, size_t base_bufsz,
 	return err;
 }
 
+/*
+ * Apply a delta to an in-memory base, writing the result directly to
+ * a file. Used for objects too large for the delta fulltext cache,
+ * where accumulating the result in memory first would only add a
+ * full-size copy of the result before it is written out.
+ */
+const struct got_error *
+got_delta_apply_mem_to_file(uint8_t *base_buf, size_t base_bufsz,
+    const uint8_t *delta_buf, size_t delta_len, FILE *outfile,
+    size_t *outsize)
+{
+	const struct got_error *err = NULL;
+	uint64_t base_size, result_size;
+	size_t remain;
+	const uint8_t *p;
+
+	*outsize = 0;
+
+	if (delta_len < GOT_DELTA_STREAM_LENGTH_MIN)
+		return got_error_msg(GOT_ERR_BAD_DELTA, "delta too small");
+
+	p = delta_buf;
+	remain = delta_len;
+	err = parse_delta_sizes(&base_size, &result_size, &p, &remain);
+	if (err)
+		return err;
+
+	/* Decode and execute copy instructions from the delta stream. */
+	err = next_delta_byte(&p, &remain);
+	while (err == NULL && remain > 0) {
+		if (*p & GOT_DELTA_BASE_COPY) {
+			off_t offset = 0;
+			size_t len = 0, n;
+
+			if (remain >= 9)
+				parse_opcode_fast(&offset, &len, &p, &remain);
+			else {
+				err = parse_opcode(&offset, &len, &p, &remain);
+				if (err)
+					break;
+			}
+			if (SIZE_MAX - offset < len || offset + len < 0 ||
+			    base_bufsz < offset + len ||
+			    *outsize + len > result_size) {
+				err = got_error_msg(GOT_ERR_BAD_DELTA,
+				    "bad delta copy length");
+				break;
+			}
+			n = fwrite(base_buf + offset, 1, len, outfile);
+			if (n != len) {
+				err = got_ferror(outfile, GOT_ERR_IO);
+				break;
+			}
+			*outsize += len;
+			if (remain > 0) {
+				p++;
+				remain--;
+			}
+		} else {
+			size_t len = (size_t)*p;
+			if (len == 0) {
+				err = got_error_msg(GOT_ERR_BAD_DELTA,
+				    "zero length delta");
+				break;
+			}
+			err = next_delta_byte(&p, &remain);
+			if (err)
+				break;
+			if (*outsize + len > result_size) {
+				err = got_error_msg(GOT_ERR_BAD_DELTA,
+				    "bad delta copy length");
+				break;
+			}
+			err = copy_from_delta(&p, &remain, len, outfile);
+			if (err == NULL)
+				*outsize += len;
+		}
+	}
+
+	if (err == NULL && *outsize != result_size)
+		err = got_error_msg(GOT_ERR_BAD_DELTA,
+		    "delta application result size mismatch");
+	return err;
+}
+
 const struct got_error *
 got_delta_apply(FILE *base_file, const uint8_t *delta_buf,
     size_t delta_len, FILE *outfile, size_t *outsize)
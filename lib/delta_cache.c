@@ -43,7 +43,6 @@
 #define GOT_DELTA_CACHE_MAX_BUCKETS		2048
 #define GOT_DELTA_CACHE_MAX_CHAIN		2
 #define GOT_DELTA_CACHE_MAX_DELTA_SIZE		1024
-#define GOT_DELTA_CACHE_MAX_FULLTEXT_SIZE	524288
 
 
 struct got_cached_delta {
@@ -127,6 +126,7 @@ got_delta_cache_free(struct got_delta_cache *cache)
 		for (j = 0; j < head->nchain; j++) {
 			delta = &head->entries[j];
 			free(delta->data);
+			free(delta->fulltext);
 		}
 	}
 	free(cache->buckets);
@@ -173,6 +173,7 @@ delta_cache_resize(struct got_delta_cache *cache, unsigned int nbuckets)
 				head->nchain++;
 			} else {
 				free(delta->data);
+				free(delta->fulltext);
 				cache->totelem--;
 			}
 		}
@@ -278,6 +279,8 @@ got_delta_cache_add_fulltext(struct got_delta_cache *cache,
 		delta = &head->entries[i];
 		if (delta->offset != delta_data_offset)
 			continue;
+		if (delta->fulltext != NULL)
+			break; /* already cached */
 		if (i > 0) {
 			struct got_cached_delta tmp;
 
@@ -15,7 +15,6 @@
  */
 
 struct got_delta {
-	STAILQ_ENTRY(got_delta) entry;
 	off_t offset;
 	size_t tslen;
 	int type;
@@ -23,20 +22,27 @@ struct got_delta {
 	off_t data_offset;
 };
 
+/*
+ * Deltas are stored in a contiguous array, ordered from the delta target
+ * at index 0 towards the delta base at index nentries - 1.
+ */
 struct got_delta_chain {
 	int nentries;
-	STAILQ_HEAD(, got_delta) entries;
+	int maxentries;
+	struct got_delta *entries;
+	uint64_t max_size;	/* cached maximum, zero until computed */
 };
 
 #define GOT_DELTA_CHAIN_RECURSION_MAX	500
 
-struct got_delta *got_delta_open(off_t, size_t, int, size_t, off_t);
 const struct got_error *got_delta_chain_get_base_type(int *,
     struct got_delta_chain *);
 const struct got_error *got_delta_get_sizes(uint64_t *, uint64_t *,
     const uint8_t *, size_t);
 const struct got_error *got_delta_apply_in_mem(uint8_t *, size_t,
     const uint8_t *, size_t, uint8_t *, size_t *, size_t);
+const struct got_error *got_delta_apply_mem_to_file(uint8_t *, size_t,
+    const uint8_t *, size_t, FILE *, size_t *);
 const struct got_error *got_delta_apply(FILE *, const uint8_t *, size_t,
     FILE *, size_t *);
 
@@ -16,6 +16,9 @@
 
 struct got_delta_cache;
 
+#define GOT_DELTA_CACHE_MAX_FULLTEXT_SIZE	524288
+
+
 const struct got_error *got_delta_cache_alloc(struct got_delta_cache **);
 void got_delta_cache_free(struct got_delta_cache *);
 
@@ -67,10 +67,16 @@ struct got_commit_object {
 };
 
 struct got_tree_entry {
+	/*
+	 * Keep the small fixed-size fields together at the front.
+	 * The inline name buffer makes each entry span several cache
+	 * lines; grouping mode, id and idx lets loops which do not
+	 * look at the full name stay within the entry's first lines.
+	 */
 	mode_t mode;
-	char name[NAME_MAX + 1 /* NUL */];
 	struct got_object_id id;
 	int idx;
+	char name[NAME_MAX + 1 /* NUL */];
 };
 
 struct got_tree_object {
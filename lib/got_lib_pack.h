@@ -21,8 +21,12 @@ struct got_pack_privsep_child {
 };
 
 /* An open pack file. */
+/* Seed for hashing pack file paths for cache lookups. */
+#define GOT_PACK_PATH_HASH_SEED	0
+
 struct got_pack {
 	char *path_packfile;
+	uint32_t path_hash; /* of path_packfile, for cache lookups */
 	int fd;
 	enum got_hash_algorithm algo;
 	uint8_t *map;
@@ -33,6 +37,9 @@ struct got_pack {
 	int child_has_tempfiles;
 	int child_has_delta_outfd;
 	struct got_delta_cache *delta_cache;
+	/* Scratch buffers recycled across delta chain applications. */
+	uint8_t *scratch[2];
+	size_t scratch_size[2];
 };
 
 struct got_packidx;
@@ -117,10 +124,14 @@ struct got_pack_large_offset_index {
 /* An open pack index file. */
 struct got_packidx {
 	char *path_packidx; /* actual on-disk path */
+	char *path_packfile; /* derived from path_packidx at open time */
+	uint32_t path_hash; /* of path_packidx, for cache lookups */
+	uint32_t path_packfile_hash; /* of path_packfile, for pack lookups */
 	int fd;
 	enum got_hash_algorithm algo;
 	uint8_t *map;
 	size_t len;
+	uint32_t nobj; /* fanout_table[0xff] in host byte order */
 	size_t nlargeobj;
 	struct got_packidx_v2_hdr hdr; /* convenient pointers into map */
 	struct got_pack_offset_index *sorted_offsets;
@@ -172,6 +172,8 @@ const struct got_error *got_repo_cache_pack(struct got_pack **,
     struct got_repository *, const char *, struct got_packidx *);
 struct got_pack *got_repo_get_cached_pack(struct got_repository *,
     const char *);
+const struct got_error *got_repo_get_pack_for_packidx(struct got_pack **,
+    struct got_repository *, struct got_packidx *);
 const struct got_error *got_repo_pin_pack(struct got_repository *,
     struct got_packidx *, struct got_pack *);
 struct got_pack *got_repo_get_pinned_pack(struct got_repository *);
@@ -48,7 +48,15 @@ got_object_id_cmp(const struct got_object_id *id1,
 {
 	if (id1->algo != id2->algo)
 		abort();
-	return memcmp(id1->hash, id2->hash, got_hash_digest_length(id1->algo));
+	/*
+	 * Compare with a constant length per algorithm such that the
+	 * compiler can expand memcmp into a few wide inline compares
+	 * instead of calling out to libc. This function sits in the
+	 * inner loop of ancestry checks and object-cache lookups.
+	 */
+	if (id1->algo == GOT_HASH_SHA1)
+		return memcmp(id1->hash, id2->hash, SHA1_DIGEST_LENGTH);
+	return memcmp(id1->hash, id2->hash, SHA256_DIGEST_LENGTH);
 }
 
 const struct got_error *
@@ -108,16 +116,34 @@ parse_digest(uint8_t *digest, int len, const char *line)
 	return 1;
 }
 
+/* Two hex digits for each byte value, "00" through "ff". */
+static const char hex2[] =
+    "000102030405060708090a0b0c0d0e0f"
+    "101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f"
+    "303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f"
+    "505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f"
+    "707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f"
+    "909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeaf"
+    "b0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecf"
+    "d0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeef"
+    "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
 static char *
 digest_to_str(const uint8_t *digest, int len, char *buf)
 {
-	const char hex[] = "0123456789abcdef";
 	char *p = buf;
 	int i;
 
 	for (i = 0; i < len; i++) {
-		*p++ = hex[digest[i] >> 4];
-		*p++ = hex[digest[i] & 0xf];
+		memcpy(p, &hex2[digest[i] * 2], 2);
+		p += 2;
 	}
 	*p = '\0';
 
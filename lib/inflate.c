@@ -65,7 +65,8 @@ got_inflate_init(struct got_inflate_buf *zb, uint8_t *outbuf, size_t bufsize,
 	if (zerr != Z_OK)
 		return wrap_inflate_error(zerr, "inflateInit");
 
-	zb->inlen = zb->outlen = bufsize;
+	zb->inlen = MIN(bufsize, GOT_INFLATE_BUFSIZE);
+	zb->outlen = bufsize;
 
 	zb->inbuf = calloc(1, zb->inlen);
 	if (zb->inbuf == NULL) {
@@ -372,20 +373,24 @@ got_inflate_to_mem_fd(uint8_t **outbuf, size_t *outlen,
 	size_t avail, consumed;
 	struct got_inflate_buf zb;
 	void *newbuf;
-	int nbuf = 1;
 	size_t bufsize = GOT_INFLATE_BUFSIZE;
 
-	/* Optimize buffer size in case short reads should suffice. */
-	if (expected_size > 0 && expected_size < bufsize)
+	/*
+	 * Sizing the output buffer for the expected result up front
+	 * avoids buffer growth, and the copying it implies, in the
+	 * common case where the result size is already known.
+	 */
+	if (expected_size > 0)
 		bufsize = expected_size;
 
 	if (outbuf) {
 		*outbuf = malloc(bufsize);
 		if (*outbuf == NULL)
 			return got_error_from_errno("malloc");
-		err = got_inflate_init(&zb, *outbuf, GOT_INFLATE_BUFSIZE, csum);
+		err = got_inflate_init(&zb, *outbuf, bufsize, csum);
 	} else
-		err = got_inflate_init(&zb, NULL, bufsize, csum);
+		err = got_inflate_init(&zb, NULL,
+		    MIN(bufsize, GOT_INFLATE_BUFSIZE), csum);
 	if (err)
 		goto done;
 
@@ -403,18 +408,19 @@ got_inflate_to_mem_fd(uint8_t **outbuf, size_t *outlen,
 		if (zb.flags & GOT_INFLATE_F_HAVE_MORE) {
 			if (outbuf == NULL)
 				continue;
-			newbuf = reallocarray(*outbuf, ++nbuf,
-			    GOT_INFLATE_BUFSIZE);
+			newbuf = realloc(*outbuf,
+			    bufsize + GOT_INFLATE_BUFSIZE);
 			if (newbuf == NULL) {
-				err = got_error_from_errno("reallocarray");
+				err = got_error_from_errno("realloc");
 				free(*outbuf);
 				*outbuf = NULL;
 				*outlen = 0;
 				goto done;
 			}
+			bufsize += GOT_INFLATE_BUFSIZE;
 			*outbuf = newbuf;
 			zb.outbuf = newbuf + *outlen;
-			zb.outlen = (nbuf * GOT_INFLATE_BUFSIZE) - *outlen;
+			zb.outlen = bufsize - *outlen;
 		}
 	} while (zb.flags & GOT_INFLATE_F_HAVE_MORE);
 
@@ -425,27 +431,36 @@ done:
 
 const struct got_error *
 got_inflate_to_mem_mmap(uint8_t **outbuf, size_t *outlen,
-    size_t *consumed_total, struct got_inflate_checksum *csum, uint8_t *map,
-    size_t offset, size_t len)
+    size_t *consumed_total, struct got_inflate_checksum *csum,
+    size_t expected_size, uint8_t *map, size_t offset, size_t len)
 {
 	const struct got_error *err;
 	size_t avail, consumed;
 	struct got_inflate_buf zb;
 	void *newbuf;
-	int nbuf = 1;
+	size_t bufsize = GOT_INFLATE_BUFSIZE;
+
+	/*
+	 * Sizing the output buffer for the expected result up front
+	 * avoids buffer growth, and the copying it implies, in the
+	 * common case where the result size is already known.
+	 */
+	if (expected_size > 0)
+		bufsize = expected_size;
 
 	if (outbuf) {
-		*outbuf = malloc(GOT_INFLATE_BUFSIZE);
+		*outbuf = malloc(bufsize);
 		if (*outbuf == NULL)
 			return got_error_from_errno("malloc");
-		err = got_inflate_init(&zb, *outbuf, GOT_INFLATE_BUFSIZE, csum);
+		err = got_inflate_init(&zb, *outbuf, bufsize, csum);
 		if (err) {
 			free(*outbuf);
 			*outbuf = NULL;
 			return err;
 		}
 	} else {
-		err = got_inflate_init(&zb, NULL, GOT_INFLATE_BUFSIZE, csum);
+		err = got_inflate_init(&zb, NULL,
+		    MIN(bufsize, GOT_INFLATE_BUFSIZE), csum);
 		if (err)
 			return err;
 	}
@@ -468,18 +483,19 @@ got_inflate_to_mem_mmap(uint8_t **outbuf, size_t *outlen,
 		if (zb.flags & GOT_INFLATE_F_HAVE_MORE) {
 			if (outbuf == NULL)
 				continue;
-			newbuf = reallocarray(*outbuf, ++nbuf,
-			    GOT_INFLATE_BUFSIZE);
+			newbuf = realloc(*outbuf,
+			    bufsize + GOT_INFLATE_BUFSIZE);
 			if (newbuf == NULL) {
-				err = got_error_from_errno("reallocarray");
+				err = got_error_from_errno("realloc");
 				free(*outbuf);
 				*outbuf = NULL;
 				*outlen = 0;
 				goto done;
 			}
+			bufsize += GOT_INFLATE_BUFSIZE;
 			*outbuf = newbuf;
 			zb.outbuf = newbuf + *outlen;
-			zb.outlen = (nbuf * GOT_INFLATE_BUFSIZE) - *outlen;
+			zb.outlen = bufsize - *outlen;
 		}
 	} while (zb.flags & GOT_INFLATE_F_HAVE_MORE);
 done:
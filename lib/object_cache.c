@@ -87,16 +87,15 @@ static size_t
 get_size_obj(struct got_object *obj)
 {
 	size_t size = sizeof(*obj);
-	struct got_delta *delta;
+	size_t deltas_size;
 
 	if ((obj->flags & GOT_OBJ_FLAG_DELTIFIED) == 0)
 		return size;
 
-	STAILQ_FOREACH(delta, &obj->deltas.entries, entry) {
-		if (SIZE_MAX - sizeof(*delta) < size)
-			return SIZE_MAX;
-		size += sizeof(*delta);
-	}
+	deltas_size = sizeof(obj->deltas.entries[0]) * obj->deltas.maxentries;
+	if (SIZE_MAX - deltas_size < size)
+		return SIZE_MAX;
+	size += deltas_size;
 
 	return size;
 }
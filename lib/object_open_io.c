@@ -49,23 +49,14 @@ got_object_open_packed(struct got_object **obj, struct got_object_id *id,
 	struct got_pack *pack = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile;
 
 	err = got_repo_search_packidx(&packidx, &idx, repo, id);
 	if (err)
 		return err;
 
-	err = got_packidx_get_packfile_path(&path_packfile,
-	    packidx->path_packidx);
+	err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 	if (err)
-		return err;
-
-	pack = got_repo_get_cached_pack(repo, path_packfile);
-	if (pack == NULL) {
-		err = got_repo_cache_pack(&pack, repo, path_packfile, packidx);
-		if (err)
-			goto done;
-	}
+		goto done;
 
 	err = got_packfile_open_object(obj, pack, packidx, idx, id);
 	if (err)
@@ -79,7 +70,6 @@ got_object_open_packed(struct got_object **obj, struct got_object_id *id,
 			err = NULL;
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -275,7 +265,6 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 	uint8_t *outbuf = NULL;
 	off_t size = 0;
 	size_t hdrlen = 0;
-	char *path_packfile = NULL;
 
 	*obj = got_repo_get_cached_raw_object(repo, id);
 	if (*obj != NULL) {
@@ -291,18 +280,9 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
 			goto done;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
 		err = read_packed_object_raw(&outbuf, &size, &hdrlen,
 		    tempfd, pack, packidx, idx, id);
 		if (err)
@@ -350,7 +330,6 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 			err = NULL;
 	}
 done:
-	free(path_packfile);
 	if (err) {
 		if (*obj) {
 			got_object_raw_close(*obj);
@@ -386,7 +365,6 @@ open_commit(struct got_commit_object **commit,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 
 	if (check_cache) {
 		*commit = got_repo_get_cached_commit(repo, id);
@@ -404,18 +382,9 @@ open_commit(struct got_commit_object **commit,
 		uint8_t *buf;
 		size_t len;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 		err = got_packfile_open_object(&obj, pack, packidx, idx, id);
 		if (err)
 			goto done;
@@ -450,7 +419,6 @@ open_commit(struct got_commit_object **commit,
 		}
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -474,6 +442,34 @@ got_object_commit_open(struct got_commit_object **commit,
 	return open_commit(commit, repo, got_object_get_id(obj), 1);
 }
 
+const struct got_error *
+got_object_open_as_commits(struct got_commit_object **commits,
+    struct got_object_id *ids, int nids, struct got_repository *repo)
+{
+	const struct got_error *err = NULL;
+	int i;
+
+	if (nids <= 0 || nids > GOT_OBJECT_OPEN_COMMITS_MAX)
+		return got_error(GOT_ERR_RANGE);
+
+	for (i = 0; i < nids; i++)
+		commits[i] = NULL;
+
+	/* Without privsep helpers there is no IPC latency to hide. */
+	for (i = 0; i < nids; i++) {
+		err = got_object_open_as_commit(&commits[i], repo, &ids[i]);
+		if (err) {
+			while (i > 0) {
+				got_object_commit_close(commits[--i]);
+				commits[i] = NULL;
+			}
+			return err;
+		}
+	}
+
+	return NULL;
+}
+
 static const struct got_error *
 open_tree(struct got_tree_object **tree,
     struct got_repository *repo, struct got_object_id *id, int check_cache)
@@ -481,7 +477,6 @@ open_tree(struct got_tree_object **tree,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 	struct got_parsed_tree_entry *entries = NULL;
 	size_t nentries = 0, nentries_alloc = 0, i;
 	uint8_t *buf = NULL;
@@ -501,18 +496,9 @@ open_tree(struct got_tree_object **tree,
 		struct got_object *obj;
 		size_t len;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 		err = got_packfile_open_object(&obj, pack, packidx, idx, id);
 		if (err)
 			goto done;
@@ -569,7 +555,6 @@ open_tree(struct got_tree_object **tree,
 		te->idx = i;
 	}
 done:
-	free(path_packfile);
 	free(entries);
 	free(buf);
 	if (err == NULL) {
@@ -742,7 +727,6 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx, dfd = -1;
-	char *path_packfile = NULL;
 	uint8_t *outbuf;
 	size_t size, hdrlen;
 	struct stat sb;
@@ -770,18 +754,9 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
 			goto done;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
 		err = read_packed_blob(&outbuf, &size, &hdrlen, outfd,
 		    pack, packidx, idx, id, repo);
 	} else if (err->code == GOT_ERR_NO_OBJ) {
@@ -840,7 +815,6 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	memcpy(&(*blob)->id, id, sizeof(*id));
 
 done:
-	free(path_packfile);
 	if (err) {
 		if (*blob) {
 			got_object_blob_close(*blob);
@@ -873,7 +847,6 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 	struct got_object *obj = NULL;
 	int obj_type = GOT_OBJ_TYPE_ANY;
 
@@ -892,18 +865,9 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 		uint8_t *buf = NULL;
 		size_t len;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 
 		/* Beware of "lightweight" tags: Check object type first. */
 		err = got_packfile_open_object(&obj, pack, packidx, idx, id);
@@ -959,7 +923,6 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 		}
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -183,29 +183,19 @@ got_object_open_packed(struct got_object **obj, struct got_object_id *id,
 	struct got_pack *pack = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile;
 
 	err = got_repo_search_packidx(&packidx, &idx, repo, id);
 	if (err)
 		return err;
 
-	err = got_packidx_get_packfile_path(&path_packfile,
-	    packidx->path_packidx);
+	err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 	if (err)
-		return err;
-
-	pack = got_repo_get_cached_pack(repo, path_packfile);
-	if (pack == NULL) {
-		err = got_repo_cache_pack(&pack, repo, path_packfile, packidx);
-		if (err)
-			goto done;
-	}
+		goto done;
 
 	err = read_packed_object_privsep(obj, repo, pack, packidx, idx, id);
 	if (err)
 		goto done;
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -227,7 +217,6 @@ got_object_read_raw_delta(uint64_t *base_size, uint64_t *result_size,
 {
 	const struct got_error *err = NULL;
 	struct got_pack *pack = NULL;
-	char *path_packfile;
 
 	*base_size = 0;
 	*result_size = 0;
@@ -236,18 +225,10 @@ got_object_read_raw_delta(uint64_t *base_size, uint64_t *result_size,
 	*delta_offset = 0;
 	*delta_out_offset = 0;
 
-	err = got_packidx_get_packfile_path(&path_packfile,
-	    packidx->path_packidx);
+	err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 	if (err)
 		return err;
 
-	pack = got_repo_get_cached_pack(repo, path_packfile);
-	if (pack == NULL) {
-		err = got_repo_cache_pack(&pack, repo, path_packfile, packidx);
-		if (err)
-			return err;
-	}
-
 	if (pack->privsep_child == NULL) {
 		err = got_pack_start_privsep_child(pack, packidx);
 		if (err)
@@ -465,7 +446,6 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 	uint8_t *outbuf = NULL;
 	off_t size = 0;
 	size_t hdrlen = 0;
-	char *path_packfile = NULL;
 
 	*obj = got_repo_get_cached_raw_object(repo, id);
 	if (*obj != NULL) {
@@ -483,18 +463,9 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
 			goto done;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
 		err = read_packed_object_raw_privsep(&outbuf, &size, &hdrlen,
 		    *outfd, pack, packidx, idx, id);
 		if (err)
@@ -518,7 +489,6 @@ got_object_raw_open(struct got_raw_object **obj, int *outfd,
 
 	err = got_repo_cache_raw_object(repo, id, *obj);
 done:
-	free(path_packfile);
 	if (err) {
 		if (*obj) {
 			got_object_raw_close(*obj);
@@ -604,7 +574,6 @@ open_commit(struct got_commit_object **commit,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 
 	if (check_cache) {
 		*commit = got_repo_get_cached_commit(repo, id);
@@ -619,18 +588,9 @@ open_commit(struct got_commit_object **commit,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 		err = read_packed_commit_privsep(commit, pack,
 		    packidx, idx, id);
 	} else if (err->code == GOT_ERR_NO_OBJ) {
@@ -647,7 +607,6 @@ open_commit(struct got_commit_object **commit,
 		err = got_repo_cache_commit(repo, id, *commit);
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -671,6 +630,137 @@ got_object_commit_open(struct got_commit_object **commit,
 	return open_commit(commit, repo, got_object_get_id(obj), 1);
 }
 
+/*
+ * A commit object request which has been sent to a privsep helper
+ * but whose reply has not been received yet.
+ */
+struct got_commit_request {
+	struct imsgbuf *ibuf;
+	int packed;
+};
+
+static const struct got_error *
+send_commit_req(struct got_commit_request *req, struct got_repository *repo,
+    struct got_object_id *id)
+{
+	const struct got_error *err;
+	struct got_packidx *packidx = NULL;
+	int idx;
+
+	err = got_repo_search_packidx(&packidx, &idx, repo, id);
+	if (err == NULL) {
+		struct got_pack *pack = NULL;
+
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
+		if (err)
+			goto done;
+		if (pack->privsep_child == NULL) {
+			err = got_pack_start_privsep_child(pack, packidx);
+			if (err)
+				goto done;
+		}
+		err = got_privsep_send_commit_req(pack->privsep_child->ibuf,
+		    -1, id, idx);
+		if (err)
+			goto done;
+		req->ibuf = pack->privsep_child->ibuf;
+		req->packed = 1;
+	} else if (err->code == GOT_ERR_NO_OBJ) {
+		struct imsgbuf *ibuf;
+		int fd;
+
+		err = got_object_open_loose_fd(&fd, id, repo);
+		if (err)
+			return err;
+		if (repo->privsep_children[GOT_REPO_PRIVSEP_CHILD_COMMIT].imsg_fd
+		    == -1) {
+			err = start_child(repo, GOT_REPO_PRIVSEP_CHILD_COMMIT);
+			if (err)
+				return err;
+		}
+		ibuf = repo->privsep_children[GOT_REPO_PRIVSEP_CHILD_COMMIT].ibuf;
+		err = got_privsep_send_commit_req(ibuf, fd, id, -1);
+		if (err)
+			return err;
+		req->ibuf = ibuf;
+		req->packed = 0;
+	}
+done:
+	return err;
+}
+
+const struct got_error *
+got_object_open_as_commits(struct got_commit_object **commits,
+    struct got_object_id *ids, int nids, struct got_repository *repo)
+{
+	const struct got_error *err = NULL;
+	struct got_commit_request reqs[GOT_OBJECT_OPEN_COMMITS_MAX];
+	int i, nsent = 0;
+
+	if (nids <= 0 || nids > GOT_OBJECT_OPEN_COMMITS_MAX)
+		return got_error(GOT_ERR_RANGE);
+
+	for (i = 0; i < nids; i++)
+		commits[i] = NULL;
+
+	/*
+	 * Send all requests up front such that helpers can start
+	 * reading objects while we are still busy sending requests.
+	 * Commits already present in the object cache need no request.
+	 */
+	for (i = 0; i < nids; i++) {
+		reqs[i].ibuf = NULL;
+		reqs[i].packed = 0;
+		commits[i] = got_repo_get_cached_commit(repo, &ids[i]);
+		if (commits[i] != NULL) {
+			commits[i]->refcnt++;
+			continue;
+		}
+		err = send_commit_req(&reqs[i], repo, &ids[i]);
+		if (err)
+			break;
+		nsent = i + 1;
+	}
+
+	/*
+	 * Drain replies in the order requests were sent. Replies which
+	 * are already in flight must be received even if an error has
+	 * occurred, otherwise the imsg channel would lose synchronization.
+	 */
+	for (i = 0; i < nsent; i++) {
+		const struct got_error *recv_err;
+		struct got_commit_object *commit;
+
+		if (reqs[i].ibuf == NULL)
+			continue;
+		recv_err = got_privsep_recv_commit(&commit, reqs[i].ibuf);
+		if (recv_err) {
+			if (err == NULL)
+				err = recv_err;
+			continue;
+		}
+		if (err) {
+			got_object_commit_close(commit);
+			continue;
+		}
+		if (reqs[i].packed)
+			commit->flags |= GOT_COMMIT_FLAG_PACKED;
+		commits[i] = commit;
+		commit->refcnt++;
+		err = got_repo_cache_commit(repo, &ids[i], commit);
+	}
+
+	if (err) {
+		for (i = 0; i < nids; i++) {
+			if (commits[i] != NULL) {
+				got_object_commit_close(commits[i]);
+				commits[i] = NULL;
+			}
+		}
+	}
+	return err;
+}
+
 static const struct got_error *
 request_packed_tree(struct got_tree_object **tree, struct got_pack *pack,
     int pack_idx, struct got_object_id *id)
@@ -741,7 +831,6 @@ open_tree(struct got_tree_object **tree, struct got_repository *repo,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 
 	if (check_cache) {
 		*tree = got_repo_get_cached_tree(repo, id);
@@ -756,18 +845,9 @@ open_tree(struct got_tree_object **tree, struct got_repository *repo,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 		err = read_packed_tree_privsep(tree, pack,
 		    packidx, idx, id);
 	} else if (err->code == GOT_ERR_NO_OBJ) {
@@ -784,7 +864,6 @@ open_tree(struct got_tree_object **tree, struct got_repository *repo,
 		err = got_repo_cache_tree(repo, id, *tree);
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -920,7 +999,6 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx, dfd = -1;
-	char *path_packfile = NULL;
 	uint8_t *outbuf;
 	size_t size, hdrlen;
 	struct stat sb;
@@ -948,18 +1026,9 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
 			goto done;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
 		err = read_packed_blob_privsep(&outbuf, &size, &hdrlen, outfd,
 		    pack, packidx, idx, id);
 	} else if (err->code == GOT_ERR_NO_OBJ) {
@@ -1018,7 +1087,6 @@ open_blob(struct got_blob_object **blob, struct got_repository *repo,
 	memcpy(&(*blob)->id, id, sizeof(*id));
 
 done:
-	free(path_packfile);
 	if (err) {
 		if (*blob) {
 			got_object_blob_close(*blob);
@@ -1114,7 +1182,6 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 	const struct got_error *err = NULL;
 	struct got_packidx *packidx = NULL;
 	int idx;
-	char *path_packfile = NULL;
 	struct got_object *obj = NULL;
 	int obj_type = GOT_OBJ_TYPE_ANY;
 
@@ -1131,18 +1198,9 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 	if (err == NULL) {
 		struct got_pack *pack = NULL;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
+		err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 		if (err)
-			return err;
-
-		pack = got_repo_get_cached_pack(repo, path_packfile);
-		if (pack == NULL) {
-			err = got_repo_cache_pack(&pack, repo, path_packfile,
-			    packidx);
-			if (err)
-				goto done;
-		}
+			goto done;
 
 		/* Beware of "lightweight" tags: Check object type first. */
 		err = read_packed_object_privsep(&obj, repo, pack, packidx,
@@ -1181,7 +1239,6 @@ open_tag(struct got_tag_object **tag, struct got_repository *repo,
 		err = got_repo_cache_tag(repo, id, *tag);
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -1213,7 +1270,6 @@ got_traverse_packed_commits(struct got_object_id_queue *traversed_commits,
 	const struct got_error *err = NULL;
 	struct got_pack *pack = NULL;
 	struct got_packidx *packidx = NULL;
-	char *path_packfile = NULL;
 	struct got_commit_object *changed_commit = NULL;
 	struct got_object_qid *changed_commit_qid = NULL;
 	int idx;
@@ -1225,17 +1281,9 @@ got_traverse_packed_commits(struct got_object_id_queue *traversed_commits,
 		return NULL;
 	}
 
-	err = got_packidx_get_packfile_path(&path_packfile,
-	    packidx->path_packidx);
+	err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 	if (err)
-		return err;
-
-	pack = got_repo_get_cached_pack(repo, path_packfile);
-	if (pack == NULL) {
-		err = got_repo_cache_pack(&pack, repo, path_packfile, packidx);
-		if (err)
-			goto done;
-	}
+		goto done;
 
 	if (pack->privsep_child == NULL) {
 		err = got_pack_start_privsep_child(pack, packidx);
@@ -1265,7 +1313,6 @@ got_traverse_packed_commits(struct got_object_id_queue *traversed_commits,
 		got_object_commit_close(changed_commit);
 	}
 done:
-	free(path_packfile);
 	return err;
 }
 
@@ -1279,19 +1326,10 @@ got_object_enumerate(int *found_all_objects,
 {
 	const struct got_error *err = NULL;
 	struct got_pack *pack;
-	char *path_packfile = NULL;
 
-	err = got_packidx_get_packfile_path(&path_packfile,
-	    packidx->path_packidx);
+	err = got_repo_get_pack_for_packidx(&pack, repo, packidx);
 	if (err)
-		return err;
-
-	pack = got_repo_get_cached_pack(repo, path_packfile);
-	if (pack == NULL) {
-		err = got_repo_cache_pack(&pack, repo, path_packfile, packidx);
-		if (err)
-			goto done;
-	}
+		goto done;
 
 	if (pack->privsep_child == NULL) {
 		err = got_pack_start_privsep_child(pack, packidx);
@@ -1323,6 +1361,5 @@ got_object_enumerate(int *found_all_objects,
 	err = got_privsep_recv_enumerated_objects(found_all_objects,
 	    pack->privsep_child->ibuf, cb_commit, cb_tree, cb_arg, repo);
 done:
-	free(path_packfile);
 	return err;
 }
@@ -91,14 +91,8 @@ got_object_close(struct got_object *obj)
 			return;
 	}
 
-	if (obj->flags & GOT_OBJ_FLAG_DELTIFIED) {
-		struct got_delta *delta;
-		while (!STAILQ_EMPTY(&obj->deltas.entries)) {
-			delta = STAILQ_FIRST(&obj->deltas.entries);
-			STAILQ_REMOVE_HEAD(&obj->deltas.entries, entry);
-			free(delta);
-		}
-	}
+	if (obj->flags & GOT_OBJ_FLAG_DELTIFIED)
+		free(obj->deltas.entries);
 	free(obj);
 }
 
@@ -47,6 +47,8 @@
 #include "got_lib_privsep.h"
 #include "got_lib_pack.h"
 
+#include "murmurhash2.h"
+
 #ifndef nitems
 #define nitems(_a) (sizeof(_a) / sizeof((_a)[0]))
 #endif
@@ -58,11 +60,15 @@
 static const struct got_error *
 verify_fanout_table(uint32_t *fanout_table)
 {
+	uint32_t prev, cur;
 	int i;
 
-	for (i = 0; i < 0xff - 1; i++) {
-		if (be32toh(fanout_table[i]) > be32toh(fanout_table[i + 1]))
+	prev = be32toh(fanout_table[0]);
+	for (i = 1; i <= 0xff; i++) {
+		cur = be32toh(fanout_table[i]);
+		if (prev > cur)
 			return got_error(GOT_ERR_BAD_PACKIDX);
+		prev = cur;
 	}
 
 	return NULL;
@@ -75,7 +81,8 @@ got_packidx_init_hdr(struct got_packidx *p, int verify, off_t packfile_size)
 	struct got_packidx_v2_hdr *h;
 	struct got_hash ctx;
 	uint8_t hash[GOT_HASH_DIGEST_MAXLEN];
-	size_t nobj, len_fanout, len_ids, offset, remain, digest_string_len;
+	size_t nobj, len_fanout, len_ids, len_tables, offset, remain;
+	size_t digest_string_len;
 	ssize_t n;
 	int i;
 
@@ -114,7 +121,7 @@ got_packidx_init_hdr(struct got_packidx *p, int verify, off_t packfile_size)
 	offset += sizeof(*h->magic);
 	remain -= sizeof(*h->magic);
 
-	if (verify)
+	if (verify && p->map == NULL)
 		got_hash_update(&ctx, h->magic, sizeof(*h->magic));
 
 	if (remain < sizeof(*h->version)) {
@@ -145,7 +152,7 @@ got_packidx_init_hdr(struct got_packidx *p, int verify, off_t packfile_size)
 	offset += sizeof(*h->version);
 	remain -= sizeof(*h->version);
 
-	if (verify)
+	if (verify && p->map == NULL)
 		got_hash_update(&ctx, h->version, sizeof(*h->version));
 
 	len_fanout =
@@ -174,87 +181,67 @@ got_packidx_init_hdr(struct got_packidx *p, int verify, off_t packfile_size)
 	err = verify_fanout_table(h->fanout_table);
 	if (err)
 		goto done;
-	if (verify)
+	if (verify && p->map == NULL)
 		got_hash_update(&ctx, h->fanout_table, len_fanout);
 	offset += len_fanout;
 	remain -= len_fanout;
 
 	nobj = be32toh(h->fanout_table[0xff]);
+	p->nobj = nobj;
 	len_ids = nobj * got_hash_digest_length(p->algo);
-	if (len_ids <= nobj || len_ids > remain) {
+	len_tables = len_ids + 2 * nobj * sizeof(*h->crc32);
+	if (len_ids <= nobj || len_ids > remain ||
+	    remain - len_ids < 2 * nobj * sizeof(*h->crc32)) {
 		err = got_error(GOT_ERR_BAD_PACKIDX);
 		goto done;
 	}
-	if (p->map)
+	if (p->map) {
 		h->sorted_ids = p->map + offset;
-	else {
+		h->crc32 = (uint32_t *)(p->map + offset + len_ids);
+		h->offsets = (uint32_t *)(p->map + offset + len_ids +
+		    nobj * sizeof(*h->crc32));
+	} else {
+		struct iovec iov[3];
+
 		h->sorted_ids = malloc(len_ids);
 		if (h->sorted_ids == NULL) {
-			err = got_error(GOT_ERR_BAD_PACKIDX);
-			goto done;
-		}
-		n = read(p->fd, h->sorted_ids, len_ids);
-		if (n < 0)
-			err = got_error_from_errno("read");
-		else if (n != len_ids) {
-			err = got_error(GOT_ERR_BAD_PACKIDX);
+			err = got_error_from_errno("malloc");
 			goto done;
 		}
-	}
-	if (verify)
-		got_hash_update(&ctx, h->sorted_ids, len_ids);
-	offset += len_ids;
-	remain -= len_ids;
-
-	if (remain < nobj * sizeof(*h->crc32)) {
-		err = got_error(GOT_ERR_BAD_PACKIDX);
-		goto done;
-	}
-	if (p->map)
-		h->crc32 = (uint32_t *)((uint8_t*)(p->map + offset));
-	else {
 		h->crc32 = malloc(nobj * sizeof(*h->crc32));
 		if (h->crc32 == NULL) {
 			err = got_error_from_errno("malloc");
 			goto done;
 		}
-		n = read(p->fd, h->crc32, nobj * sizeof(*h->crc32));
-		if (n < 0)
-			err = got_error_from_errno("read");
-		else if (n != nobj * sizeof(*h->crc32)) {
-			err = got_error(GOT_ERR_BAD_PACKIDX);
-			goto done;
-		}
-	}
-	if (verify)
-		got_hash_update(&ctx, h->crc32, nobj * sizeof(*h->crc32));
-	remain -= nobj * sizeof(*h->crc32);
-	offset += nobj * sizeof(*h->crc32);
-
-	if (remain < nobj * sizeof(*h->offsets)) {
-		err = got_error(GOT_ERR_BAD_PACKIDX);
-		goto done;
-	}
-	if (p->map)
-		h->offsets = (uint32_t *)((uint8_t*)(p->map + offset));
-	else {
 		h->offsets = malloc(nobj * sizeof(*h->offsets));
 		if (h->offsets == NULL) {
 			err = got_error_from_errno("malloc");
 			goto done;
 		}
-		n = read(p->fd, h->offsets, nobj * sizeof(*h->offsets));
-		if (n < 0)
-			err = got_error_from_errno("read");
-		else if (n != nobj * sizeof(*h->offsets)) {
+
+		/* Read the three fixed-size object tables in one go. */
+		iov[0].iov_base = h->sorted_ids;
+		iov[0].iov_len = len_ids;
+		iov[1].iov_base = h->crc32;
+		iov[1].iov_len = nobj * sizeof(*h->crc32);
+		iov[2].iov_base = h->offsets;
+		iov[2].iov_len = nobj * sizeof(*h->offsets);
+		n = readv(p->fd, iov, nitems(iov));
+		if (n < 0) {
+			err = got_error_from_errno("readv");
+			goto done;
+		} else if (n != len_tables) {
 			err = got_error(GOT_ERR_BAD_PACKIDX);
 			goto done;
 		}
 	}
-	if (verify)
+	if (verify && p->map == NULL) {
+		got_hash_update(&ctx, h->sorted_ids, len_ids);
+		got_hash_update(&ctx, h->crc32, nobj * sizeof(*h->crc32));
 		got_hash_update(&ctx, h->offsets, nobj * sizeof(*h->offsets));
-	remain -= nobj * sizeof(*h->offsets);
-	offset += nobj * sizeof(*h->offsets);
+	}
+	remain -= len_tables;
+	offset += len_tables;
 
 	/* Large file offsets are contained only in files > 2GB. */
 	if (verify || packfile_size > 0x7fffffff) {
@@ -293,7 +280,7 @@ got_packidx_init_hdr(struct got_packidx *p, int verify, off_t packfile_size)
 			goto done;
 		}
 	}
-	if (verify)
+	if (verify && p->map == NULL)
 		got_hash_update(&ctx, h->large_offsets,
 		    p->nlargeobj * sizeof(*h->large_offsets));
 	remain -= p->nlargeobj * sizeof(*h->large_offsets);
@@ -326,8 +313,18 @@ checksum:
 		}
 	}
 	if (verify) {
-		got_hash_update(&ctx, h->trailer.packfile_hash,
-		    digest_string_len);
+		/*
+		 * With the file mapped, feed the digest one contiguous
+		 * block covering everything up to the trailing checksum
+		 * instead of one update call per section; large blocks
+		 * keep the hash provider's block loop saturated.
+		 */
+		if (p->map)
+			got_hash_update(&ctx, p->map,
+			    p->len - digest_string_len);
+		else
+			got_hash_update(&ctx, h->trailer.packfile_hash,
+			    digest_string_len);
 		got_hash_final(&ctx, hash);
 		if (got_hash_cmp(ctx.algo, hash, h->trailer.packidx_hash) != 0)
 			err = got_error(GOT_ERR_PACKIDX_CSUM);
@@ -394,6 +391,18 @@ got_packidx_open(struct got_packidx **packidx,
 		err = got_error_from_errno("strdup");
 		goto done;
 	}
+	p->path_hash = murmurhash2(p->path_packidx, strlen(p->path_packidx),
+	    GOT_PACK_PATH_HASH_SEED);
+
+	/*
+	 * Keep the derived pack file path around; looking up the pack
+	 * which corresponds to this index is a per-object operation
+	 * and should not cost an allocation each time.
+	 */
+	p->path_packfile = pack_relpath;
+	pack_relpath = NULL;
+	p->path_packfile_hash = murmurhash2(p->path_packfile,
+	    strlen(p->path_packfile), GOT_PACK_PATH_HASH_SEED);
 
 #ifndef GOT_PACK_NO_MMAP
 	if (p->len > 0 && p->len <= SIZE_MAX) {
@@ -404,6 +413,14 @@ got_packidx_open(struct got_packidx **packidx,
 				goto done;
 			}
 			p->map = NULL; /* fall back to read(2) */
+		} else {
+			/*
+			 * Object ID lookups bisect the sorted ID table,
+			 * touching scattered pages; sequential readahead
+			 * around each fault is wasted effort.
+			 */
+			(void)posix_madvise(p->map, p->len,
+			    POSIX_MADV_RANDOM);
 		}
 	}
 #endif
@@ -425,6 +442,7 @@ got_packidx_close(struct got_packidx *packidx)
 	const struct got_error *err = NULL;
 
 	free(packidx->path_packidx);
+	free(packidx->path_packfile);
 	if (packidx->map) {
 		if (munmap(packidx->map, packidx->len) == -1)
 			err = got_error_from_errno("munmap");
@@ -492,12 +510,40 @@ got_packidx_get_object_idx(struct got_packidx *packidx,
     struct got_object_id *id)
 {
 	u_int8_t id0 = id->hash[0];
-	uint32_t totobj = be32toh(packidx->hdr.fanout_table[0xff]);
-	int left = 0, right = totobj - 1;
+	int left = 0, right;
 	size_t digest_len = got_hash_digest_length(packidx->algo);
 
+	/*
+	 * The fanout table bounds both ends of the search: entries
+	 * with leading byte id0 occupy the range between the previous
+	 * bucket's cumulative count and this bucket's.
+	 */
 	if (id0 > 0)
 		left = be32toh(packidx->hdr.fanout_table[id0 - 1]);
+	right = be32toh(packidx->hdr.fanout_table[id0]) - 1;
+
+	/*
+	 * Fanout buckets are small in most packs. For short ranges a
+	 * linear scan which prefilters on the first four hash bytes
+	 * beats binary search; the mispredicted halving branches cost
+	 * more than a short run of sequential word compares.
+	 */
+	if (right - left < 8) {
+		uint32_t key, first4;
+		int i;
+
+		memcpy(&key, id->hash, sizeof(key));
+		for (i = left; i <= right; i++) {
+			uint8_t *oid = packidx->hdr.sorted_ids + i * digest_len;
+
+			memcpy(&first4, oid, sizeof(first4));
+			if (first4 != key)
+				continue;
+			if (got_hash_cmp(packidx->algo, id->hash, oid) == 0)
+				return i;
+		}
+		return -1;
+	}
 
 	while (left <= right) {
 		uint8_t *oid;
@@ -505,7 +551,12 @@ got_packidx_get_object_idx(struct got_packidx *packidx,
 
 		i = ((left + right) / 2);
 		oid = packidx->hdr.sorted_ids + i * digest_len;
-		cmp = memcmp(id->hash, oid, digest_len);
+		/*
+		 * got_hash_cmp compares with a digest length known at
+		 * compile time, letting the compiler inline the
+		 * comparison into a few wide register operations.
+		 */
+		cmp = got_hash_cmp(packidx->algo, id->hash, oid);
 		if (cmp == 0)
 			return i;
 		else if (cmp > 0)
@@ -552,7 +603,7 @@ large_offset_cmp(const void *pa, const void *pb)
 static const struct got_error *
 build_offset_index(struct got_packidx *p)
 {
-	uint32_t nobj = be32toh(p->hdr.fanout_table[0xff]);
+	uint32_t nobj = p->nobj;
 	unsigned int i, j, k;
 
 	p->sorted_offsets = calloc(nobj - p->nlargeobj,
@@ -606,7 +657,7 @@ const struct got_error *
 got_packidx_get_offset_idx(int *idx, struct got_packidx *packidx, off_t offset)
 {
 	const struct got_error *err;
-	uint32_t totobj = be32toh(packidx->hdr.fanout_table[0xff]);
+	uint32_t totobj = packidx->nobj;
 	int i, left, right;
 
 	*idx = -1;
@@ -654,7 +705,7 @@ const struct got_error *
 got_packidx_get_object_id(struct got_object_id *id,
     struct got_packidx *packidx, int idx)
 {
-	uint32_t totobj = be32toh(packidx->hdr.fanout_table[0xff]);
+	uint32_t totobj = packidx->nobj;
 	uint8_t *oid;
 	size_t digest_len = got_hash_digest_length(packidx->algo);
 
@@ -673,7 +724,7 @@ got_packidx_match_id_str_prefix(struct got_object_id_queue *matched_ids,
 {
 	const struct got_error *err = NULL;
 	u_int8_t id0;
-	uint32_t totobj = be32toh(packidx->hdr.fanout_table[0xff]);
+	uint32_t totobj = packidx->nobj;
 	char hex[3];
 	size_t prefix_len = strlen(id_str_prefix);
 	uint8_t *oid;
@@ -827,6 +878,7 @@ const struct got_error *
 got_pack_close(struct got_pack *pack)
 {
 	const struct got_error *err = NULL;
+	int i;
 
 	err = pack_stop_privsep_child(pack);
 	if (pack->map && munmap(pack->map, pack->filesize) == -1 && !err)
@@ -842,6 +894,12 @@ got_pack_close(struct got_pack *pack)
 		pack->delta_cache = NULL;
 	}
 
+	for (i = 0; i < nitems(pack->scratch); i++) {
+		free(pack->scratch[i]);
+		pack->scratch[i] = NULL;
+		pack->scratch_size[i] = 0;
+	}
+
 	/*
 	 * Leave accumfd and basefd alone. They are managed by the
 	 * repository layer and can be reused.
@@ -856,8 +914,9 @@ got_pack_parse_object_type_and_size(uint8_t *type, uint64_t *size, size_t *len,
 {
 	uint8_t t = 0;
 	uint64_t s = 0;
+	uint8_t buf[10]; /* size values beyond 64 bit are unsupported */
 	uint8_t sizeN;
-	size_t mapoff = 0;
+	size_t navail;
 	int i = 0;
 
 	*len = 0;
@@ -865,6 +924,12 @@ got_pack_parse_object_type_and_size(uint8_t *type, uint64_t *size, size_t *len,
 	if (offset >= pack->filesize)
 		return got_error(GOT_ERR_PACK_OFFSET);
 
+	/*
+	 * Gather the encoded bytes up front; decoding one byte at a
+	 * time would otherwise cost one read(2) call per byte on the
+	 * non-mmap path, and every packed object header passes through
+	 * here.
+	 */
 	if (pack->map) {
 		if (offset > SIZE_MAX) {
 			return got_error_fmt(GOT_ERR_PACK_OFFSET,
@@ -872,10 +937,13 @@ got_pack_parse_object_type_and_size(uint8_t *type, uint64_t *size, size_t *len,
 			    (long long)offset);
 		}
 
-		mapoff = (size_t)offset;
+		navail = MIN(sizeof(buf), pack->filesize - offset - 1);
+		memcpy(buf, pack->map + (size_t)offset, navail);
 	} else {
-		if (lseek(pack->fd, offset, SEEK_SET) == -1)
-			return got_error_from_errno("lseek");
+		ssize_t n = pread(pack->fd, buf, sizeof(buf), offset);
+		if (n < 0)
+			return got_error_from_errno("pread");
+		navail = n;
 	}
 
 	do {
@@ -884,18 +952,9 @@ got_pack_parse_object_type_and_size(uint8_t *type, uint64_t *size, size_t *len,
 			return got_error_fmt(GOT_ERR_OBJ_TOO_LARGE,
 			    "packfile offset %lld", (long long)offset);
 
-		if (pack->map) {
-			if (mapoff + sizeof(sizeN) >= pack->filesize)
-				return got_error(GOT_ERR_BAD_PACKFILE);
-			sizeN = *(pack->map + mapoff);
-			mapoff += sizeof(sizeN);
-		} else {
-			ssize_t n = read(pack->fd, &sizeN, sizeof(sizeN));
-			if (n < 0)
-				return got_error_from_errno("read");
-			if (n != sizeof(sizeN))
-				return got_error(GOT_ERR_BAD_PACKFILE);
-		}
+		if (i >= navail)
+			return got_error(GOT_ERR_BAD_PACKFILE);
+		sizeN = buf[i];
 		*len += sizeof(sizeN);
 
 		if (i == 0) {
@@ -909,6 +968,11 @@ got_pack_parse_object_type_and_size(uint8_t *type, uint64_t *size, size_t *len,
 		i++;
 	} while (sizeN & GOT_PACK_OBJ_SIZE_MORE);
 
+	/* Leave the file position where sequential readers expect it. */
+	if (pack->map == NULL &&
+	    lseek(pack->fd, offset + *len, SEEK_SET) == -1)
+		return got_error_from_errno("lseek");
+
 	*type = t;
 	*size = s;
 	return NULL;
@@ -938,38 +1002,46 @@ parse_negative_offset(int64_t *offset, size_t *len, struct got_pack *pack,
     off_t delta_offset)
 {
 	int64_t o = 0;
+	uint8_t buf[9]; /* offset values beyond 64 bit are unsupported */
 	uint8_t offN;
+	size_t navail;
 	int i = 0;
 
 	*offset = 0;
 	*len = 0;
 
+	/*
+	 * Gather the encoded bytes up front, as in
+	 * got_pack_parse_object_type_and_size().
+	 */
+	if (pack->map) {
+		if (delta_offset > SIZE_MAX) {
+			return got_error_fmt(GOT_ERR_PACK_OFFSET,
+			    "mapoff %lld would overflow size_t",
+			    (long long)delta_offset);
+		}
+		if (delta_offset + 1 >= pack->filesize)
+			return got_error(GOT_ERR_PACK_OFFSET);
+		navail = MIN(sizeof(buf),
+		    pack->filesize - delta_offset - 1);
+		memcpy(buf, pack->map + (size_t)delta_offset, navail);
+	} else {
+		ssize_t n = pread(pack->fd, buf, sizeof(buf), delta_offset);
+		if (n < 0)
+			return got_error_from_errno("pread");
+		navail = n;
+	}
+
 	do {
 		/* We do not support offset values which don't fit in 64 bit. */
 		if (i > 8)
 			return got_error(GOT_ERR_NO_SPACE);
 
-		if (pack->map) {
-			size_t mapoff;
-
-			if (delta_offset > SIZE_MAX - *len) {
-				return got_error_fmt(GOT_ERR_PACK_OFFSET,
-				    "mapoff %lld would overflow size_t",
-				    (long long)delta_offset + *len);
-			}
-
-			mapoff = (size_t)delta_offset + *len;
-			if (mapoff + sizeof(offN) >= pack->filesize)
-				return got_error(GOT_ERR_PACK_OFFSET);
-			offN = *(pack->map + mapoff);
-		} else {
-			ssize_t n;
-			n = read(pack->fd, &offN, sizeof(offN));
-			if (n < 0)
-				return got_error_from_errno("read");
-			if (n != sizeof(offN))
-				return got_error(GOT_ERR_BAD_PACKFILE);
+		if (i >= navail) {
+			return got_error(pack->map ? GOT_ERR_PACK_OFFSET :
+			    GOT_ERR_BAD_PACKFILE);
 		}
+		offN = buf[i];
 		*len += sizeof(offN);
 
 		if (i == 0)
@@ -982,6 +1054,11 @@ parse_negative_offset(int64_t *offset, size_t *len, struct got_pack *pack,
 		i++;
 	} while (offN & GOT_PACK_OBJ_DELTA_OFF_MORE);
 
+	/* Leave the file position where sequential readers expect it. */
+	if (pack->map == NULL &&
+	    lseek(pack->fd, delta_offset + *len, SEEK_SET) == -1)
+		return got_error_from_errno("lseek");
+
 	*offset = o;
 	return NULL;
 }
@@ -1010,10 +1087,14 @@ got_pack_parse_offset_delta(off_t *base_offset, size_t *len,
 	return NULL;
 }
 
+/*
+ * The expected size stems from the delta's pack object header and
+ * lets inflate size its output buffer up front.
+ */
 static const struct got_error *
 read_delta_data(uint8_t **delta_buf, size_t *delta_len,
-    size_t *delta_compressed_len, size_t delta_data_offset,
-    struct got_pack *pack)
+    size_t *delta_compressed_len, size_t expected_size,
+    size_t delta_data_offset, struct got_pack *pack)
 {
 	const struct got_error *err = NULL;
 	size_t consumed = 0;
@@ -1022,15 +1103,15 @@ read_delta_data(uint8_t **delta_buf, size_t *delta_len,
 		if (delta_data_offset >= pack->filesize)
 			return got_error(GOT_ERR_PACK_OFFSET);
 		err = got_inflate_to_mem_mmap(delta_buf, delta_len,
-		    &consumed, NULL, pack->map, delta_data_offset,
-		    pack->filesize - delta_data_offset);
+		    &consumed, NULL, expected_size, pack->map,
+		    delta_data_offset, pack->filesize - delta_data_offset);
 		if (err)
 			return err;
 	} else {
 		if (lseek(pack->fd, delta_data_offset, SEEK_SET) == -1)
 			return got_error_from_errno("lseek");
 		err = got_inflate_to_mem_fd(delta_buf, delta_len,
-		    &consumed, NULL, 0, pack->fd);
+		    &consumed, NULL, expected_size, pack->fd);
 		if (err)
 			return err;
 	}
@@ -1047,13 +1128,25 @@ add_delta(struct got_delta_chain *deltas, off_t delta_offset, size_t tslen,
 {
 	struct got_delta *delta;
 
-	delta = got_delta_open(delta_offset, tslen, delta_type, delta_size,
-	    delta_data_offset);
-	if (delta == NULL)
-		return got_error_from_errno("got_delta_open");
-	/* delta is freed in got_object_close() */
-	deltas->nentries++;
-	STAILQ_INSERT_HEAD(&deltas->entries, delta, entry);
+	/* The entries array is freed in got_object_close(). */
+	if (deltas->nentries >= deltas->maxentries) {
+		struct got_delta *new;
+		int maxentries;
+
+		maxentries = deltas->maxentries ? deltas->maxentries * 2 : 8;
+		new = reallocarray(deltas->entries, maxentries, sizeof(*new));
+		if (new == NULL)
+			return got_error_from_errno("reallocarray");
+		deltas->entries = new;
+		deltas->maxentries = maxentries;
+	}
+
+	delta = &deltas->entries[deltas->nentries++];
+	delta->offset = delta_offset;
+	delta->tslen = tslen;
+	delta->type = delta_type;
+	delta->size = delta_size;
+	delta->data_offset = delta_data_offset;
 	return NULL;
 }
 
@@ -1079,12 +1172,6 @@ resolve_offset_delta(struct got_delta_chain *deltas,
 	if (delta_data_offset >= pack->filesize)
 		return got_error(GOT_ERR_PACK_OFFSET);
 
-	if (pack->map == NULL) {
-		delta_data_offset = lseek(pack->fd, 0, SEEK_CUR);
-		if (delta_data_offset == -1)
-			return got_error_from_errno("lseek");
-	}
-
 	err = add_delta(deltas, delta_offset, tslen, delta_type, delta_size,
 	    delta_data_offset);
 	if (err)
@@ -1127,9 +1214,10 @@ got_pack_parse_ref_delta(struct got_object_id *id,
 		memcpy(id->hash, pack->map + mapoff, digest_len);
 	} else {
 		ssize_t n;
-		n = read(pack->fd, id->hash, digest_len);
+		n = pread(pack->fd, id->hash, digest_len,
+		    delta_offset + tslen);
 		if (n < 0)
-			return got_error_from_errno("read");
+			return got_error_from_errno("pread");
 		if (n != digest_len)
 			return got_error(GOT_ERR_BAD_PACKFILE);
 	}
@@ -1157,15 +1245,9 @@ resolve_ref_delta(struct got_delta_chain *deltas, struct got_packidx *packidx,
 	err = got_pack_parse_ref_delta(&id, pack, delta_offset, tslen);
 	if (err)
 		return err;
-	if (pack->map) {
-		delta_data_offset = delta_offset + tslen +
-		    got_hash_digest_length(packidx->algo);
-	} else {
-		delta_data_offset = lseek(pack->fd, 0, SEEK_CUR);
-		if (delta_data_offset == -1)
-			return got_error_from_errno("lseek");
-	}
 
+	delta_data_offset = delta_offset + tslen +
+	    got_hash_digest_length(packidx->algo);
 	err = add_delta(deltas, delta_offset, tslen, delta_type, delta_size,
 	    delta_data_offset);
 	if (err)
@@ -1202,26 +1284,27 @@ got_pack_resolve_delta_chain(struct got_delta_chain *deltas,
 	if (--recursion == 0)
 		return got_error(GOT_ERR_RECURSION);
 
-	switch (delta_type) {
-	case GOT_OBJ_TYPE_COMMIT:
-	case GOT_OBJ_TYPE_TREE:
-	case GOT_OBJ_TYPE_BLOB:
-	case GOT_OBJ_TYPE_TAG:
+	/*
+	 * Test for the offset-delta case first. Git packs deltas against
+	 * objects in the same pack file by default, so long delta chains
+	 * consist almost entirely of offset deltas, with one plain type
+	 * at the end of the chain and ref deltas only in thin packs.
+	 */
+	if (delta_type == GOT_OBJ_TYPE_OFFSET_DELTA) {
+		err = resolve_offset_delta(deltas, packidx, pack,
+		    delta_offset, tslen, delta_type, delta_size, recursion - 1);
+	} else if (delta_type == GOT_OBJ_TYPE_COMMIT ||
+	    delta_type == GOT_OBJ_TYPE_TREE ||
+	    delta_type == GOT_OBJ_TYPE_BLOB ||
+	    delta_type == GOT_OBJ_TYPE_TAG) {
 		/* Plain types are the final delta base. Recursion ends. */
 		err = add_delta(deltas, delta_offset, tslen, delta_type,
 		    delta_size, 0);
-		break;
-	case GOT_OBJ_TYPE_OFFSET_DELTA:
-		err = resolve_offset_delta(deltas, packidx, pack,
-		    delta_offset, tslen, delta_type, delta_size, recursion - 1);
-		break;
-	case GOT_OBJ_TYPE_REF_DELTA:
+	} else if (delta_type == GOT_OBJ_TYPE_REF_DELTA) {
 		err = resolve_ref_delta(deltas, packidx, pack,
 		    delta_offset, tslen, delta_type, delta_size, recursion - 1);
-		break;
-	default:
+	} else
 		return got_error(GOT_ERR_OBJ_TYPE);
-	}
 
 	return err;
 }
@@ -1244,7 +1327,6 @@ open_delta_object(struct got_object **obj, struct got_packidx *packidx,
 	memcpy(&(*obj)->id, id, sizeof((*obj)->id));
 	(*obj)->pack_offset = offset + tslen;
 
-	STAILQ_INIT(&(*obj)->deltas.entries);
 	(*obj)->flags |= GOT_OBJ_FLAG_DELTIFIED;
 	(*obj)->flags |= GOT_OBJ_FLAG_PACKED;
 	(*obj)->pack_idx = idx;
@@ -1315,9 +1397,22 @@ got_pack_get_delta_chain_max_size(uint64_t *max_size,
 {
 	struct got_delta *delta;
 	uint64_t base_size = 0, result_size = 0;
+	int i;
+
+	/*
+	 * Object size queries and delta application both need the
+	 * chain's maximum; remember it so the chain is walked at most
+	 * once per object.
+	 */
+	if (deltas->max_size > 0) {
+		*max_size = deltas->max_size;
+		return NULL;
+	}
 
 	*max_size = 0;
-	STAILQ_FOREACH(delta, &deltas->entries, entry) {
+	/* Walk the chain from the delta base towards the delta target. */
+	for (i = deltas->nentries - 1; i >= 0; i--) {
+		delta = &deltas->entries[i];
 		/* Plain object types are the delta base. */
 		if (delta->type != GOT_OBJ_TYPE_COMMIT &&
 		    delta->type != GOT_OBJ_TYPE_TREE &&
@@ -1336,7 +1431,8 @@ got_pack_get_delta_chain_max_size(uint64_t *max_size,
 			if (delta_buf == NULL) {
 				cached = 0;
 				err = read_delta_data(&delta_buf, &delta_len,
-				    NULL, delta->data_offset, pack);
+				    NULL, delta->size, delta->data_offset,
+				    pack);
 				if (err)
 					return err;
 			}
@@ -1364,6 +1460,7 @@ got_pack_get_delta_chain_max_size(uint64_t *max_size,
 			*max_size = result_size;
 	}
 
+	deltas->max_size = *max_size;
 	return NULL;
 }
 
@@ -1377,6 +1474,66 @@ got_pack_get_max_delta_object_size(uint64_t *size, struct got_object *obj,
 	return got_pack_get_delta_chain_max_size(size, &obj->deltas, pack);
 }
 
+/*
+ * Delta application needs two large temporary buffers per object.
+ * Recycling them via a small per-pack pool spares the allocator a
+ * pair of multi-megabyte malloc/free calls for every extracted
+ * object, and keeps delta application working within the same
+ * already-mapped pages. Buffers obtained from the pool are plain
+ * heap allocations and may be handed over to callers; they simply
+ * cease to be pool members once taken.
+ */
+static uint8_t *
+pack_scratch_get(struct got_pack *pack, size_t size)
+{
+	uint8_t *buf;
+	int i, fit = -1;
+
+	for (i = 0; i < nitems(pack->scratch); i++) {
+		if (pack->scratch[i] == NULL ||
+		    pack->scratch_size[i] < size)
+			continue;
+		if (fit == -1 ||
+		    pack->scratch_size[i] < pack->scratch_size[fit])
+			fit = i;
+	}
+	if (fit != -1) {
+		buf = pack->scratch[fit];
+		pack->scratch[fit] = NULL;
+		pack->scratch_size[fit] = 0;
+		return buf;
+	}
+
+	return malloc(size);
+}
+
+static void
+pack_scratch_put(struct got_pack *pack, uint8_t *buf, size_t size)
+{
+	int i, smallest = 0;
+
+	if (buf == NULL)
+		return;
+
+	for (i = 0; i < nitems(pack->scratch); i++) {
+		if (pack->scratch[i] == NULL) {
+			pack->scratch[i] = buf;
+			pack->scratch_size[i] = size;
+			return;
+		}
+		if (pack->scratch_size[i] < pack->scratch_size[smallest])
+			smallest = i;
+	}
+
+	/* All slots are occupied; keep the larger buffer around. */
+	if (pack->scratch_size[smallest] < size) {
+		free(pack->scratch[smallest]);
+		pack->scratch[smallest] = buf;
+		pack->scratch_size[smallest] = size;
+	} else
+		free(buf);
+}
+
 const struct got_error *
 got_pack_dump_delta_chain_to_file(size_t *result_size,
     struct got_delta_chain *deltas, struct got_pack *pack, FILE *outfile,
@@ -1385,22 +1542,23 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 	const struct got_error *err = NULL;
 	struct got_delta *delta;
 	uint8_t *base_buf = NULL, *accum_buf = NULL;
-	size_t base_bufsz = 0, accum_bufsz = 0, accum_size = 0;
+	size_t base_bufsz = 0, accum_size = 0;
 	/* We process small enough files entirely in memory for speed. */
 	const size_t max_bufsize = GOT_DELTA_RESULT_SIZE_CACHED_MAX;
 	uint64_t max_size = 0;
-	int n = 0;
+	int i, n = 0, streamed = 0;
 
 	*result_size = 0;
 
-	if (STAILQ_EMPTY(&deltas->entries))
+	if (deltas->nentries == 0)
 		return got_error(GOT_ERR_BAD_DELTA_CHAIN);
 
 	if (pack->delta_cache) {
 		uint8_t *delta_buf = NULL, *fulltext = NULL;
 		size_t delta_len, fulltext_len;
 
-		delta = STAILQ_LAST(&deltas->entries, got_delta, entry);
+		/* The delta target is the first entry in the chain. */
+		delta = &deltas->entries[0];
 		got_delta_cache_get(&delta_buf, &delta_len,
 		    &fulltext, &fulltext_len,
 		    pack->delta_cache, delta->data_offset);
@@ -1417,17 +1575,41 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 		}
 	}
 
+	/*
+	 * Compute the largest object size which occurs along the chain
+	 * and size our scratch buffers for it up front. This avoids
+	 * buffer growth, and the copying it implies, while deltas are
+	 * being applied. Delta data read along the way is added to the
+	 * delta cache and will usually be found there by the loop below.
+	 */
+	err = got_pack_get_delta_chain_max_size(&max_size, deltas, pack);
+	if (err)
+		return err;
+
 	if (fseeko(base_file, 0L, SEEK_SET) == -1)
 		return got_error_from_errno("fseeko");
 	if (fseeko(accum_file, 0L, SEEK_SET) == -1)
 		return got_error_from_errno("fseeko");
 
-	/* Deltas are ordered in ascending order. */
-	STAILQ_FOREACH(delta, &deltas->entries, entry) {
+	/*
+	 * The temporary files may contain leftover data from a previous,
+	 * larger object. Truncate them such that file length always
+	 * matches content length; a corrupt delta which copies from
+	 * beyond its base's end must hit EOF, not stale bytes.
+	 */
+	if (max_size > max_bufsize) {
+		if (ftruncate(fileno(base_file), 0L) == -1)
+			return got_error_from_errno("ftruncate");
+		if (ftruncate(fileno(accum_file), 0L) == -1)
+			return got_error_from_errno("ftruncate");
+	}
+
+	/* Walk the chain from the delta base towards the delta target. */
+	for (i = deltas->nentries - 1; i >= 0; i--) {
 		uint8_t *delta_buf = NULL, *fulltext = NULL;
 		size_t delta_len, fulltext_len;
-		uint64_t base_size, result_size = 0;
 		int cached = 1;
+		delta = &deltas->entries[i];
 		if (n == 0) {
 			size_t mapoff;
 			off_t delta_data_offset;
@@ -1453,8 +1635,6 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 					goto done;
 				}
 			}
-			if (delta->size > max_size)
-				max_size = delta->size;
 			if (max_size > max_bufsize) {
 				if (pack->map) {
 					if (delta_data_offset > SIZE_MAX) {
@@ -1476,12 +1656,11 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 					    &base_bufsz, NULL, NULL, pack->fd,
 					    base_file);
 			} else {
-				accum_buf = malloc(max_size);
+				accum_buf = pack_scratch_get(pack, max_size);
 				if (accum_buf == NULL) {
 					err = got_error_from_errno("malloc");
 					goto done;
 				}
-				accum_bufsz = max_size;
 				if (pack->map) {
 					if (delta_data_offset > SIZE_MAX) {
 						err = got_error_fmt(
@@ -1495,7 +1674,7 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 
 					mapoff = delta_data_offset;
 					err = got_inflate_to_mem_mmap(&base_buf,
-					    &base_bufsz, NULL, NULL,
+					    &base_bufsz, NULL, NULL, max_size,
 					    pack->map, mapoff,
 					    pack->filesize - mapoff);
 				} else
@@ -1537,7 +1716,7 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 		if (delta_buf == NULL) {
 			cached = 0;
 			err = read_delta_data(&delta_buf, &delta_len, NULL,
-			    delta->data_offset, pack);
+			    delta->size, delta->data_offset, pack);
 			if (err)
 				goto done;
 		}
@@ -1552,65 +1731,42 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 			}
 		}
 
-		err = got_delta_get_sizes(&base_size, &result_size,
-		    delta_buf, delta_len);
-		if (err) {
-			if (!cached)
-				free(delta_buf);
-			goto done;
-		}
-		if (base_size > max_size)
-			max_size = base_size;
-		if (result_size > max_size)
-			max_size = result_size;
-		if (fulltext_len > max_size)
-			max_size = fulltext_len;
-
-		if (base_buf && max_size > max_bufsize) {
-			/* Switch from buffers to temporary files. */
-			size_t w = fwrite(base_buf, 1, base_bufsz,
-			    base_file);
-			if (w != base_bufsz) {
-				err = got_ferror(outfile, GOT_ERR_IO);
-				if (!cached)
-					free(delta_buf);
-				goto done;
-			}
-			free(base_buf);
-			base_buf = NULL;
-			free(accum_buf);
-			accum_buf = NULL;
+		/* The chain's maximum covers any cached fulltext. */
+		if (fulltext && fulltext_len > max_size) {
+			fulltext = NULL;
+			fulltext_len = 0;
 		}
 
-		if (base_buf && max_size > base_bufsz) {
-			uint8_t *p = realloc(base_buf, max_size);
-			if (p == NULL) {
-				err = got_error_from_errno("realloc");
-				if (!cached)
-					free(delta_buf);
-				goto done;
-			}
-			base_buf = p;
-			base_bufsz = max_size;
-		}
+		if (base_buf) {
+			uint64_t target_size = 0;
 
-		if (accum_buf && max_size > accum_bufsz) {
-			uint8_t *p = realloc(accum_buf, max_size);
-			if (p == NULL) {
-				err = got_error_from_errno("realloc");
-				if (!cached)
-					free(delta_buf);
-				goto done;
-			}
-			accum_buf = p;
-			accum_bufsz = max_size;
-		}
+			if (fulltext == NULL && i == 0) {
+				uint64_t base_size;
 
-		if (base_buf) {
+				err = got_delta_get_sizes(&base_size,
+				    &target_size, delta_buf, delta_len);
+				if (err) {
+					if (!cached)
+						free(delta_buf);
+					goto done;
+				}
+			}
 			if (fulltext) {
 				memcpy(accum_buf, fulltext, fulltext_len);
 				accum_size = fulltext_len;
 				err = NULL;
+			} else if (i == 0 &&
+			    target_size > GOT_DELTA_CACHE_MAX_FULLTEXT_SIZE) {
+				/*
+				 * The delta target is too large for the
+				 * fulltext cache. Write it straight to the
+				 * output file rather than accumulating it
+				 * in memory only to copy it there later.
+				 */
+				err = got_delta_apply_mem_to_file(base_buf,
+				    base_bufsz, delta_buf, delta_len,
+				    outfile, &accum_size);
+				streamed = 1;
 			} else {
 				err = got_delta_apply_in_mem(base_buf,
 				    base_bufsz, delta_buf, delta_len,
@@ -1621,7 +1777,7 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 				free(delta_buf);
 			if (err)
 				goto done;
-			if (fulltext == NULL) {
+			if (fulltext == NULL && !streamed) {
 				err = got_delta_cache_add_fulltext(
 				    pack->delta_cache, delta->data_offset,
 				    accum_buf, accum_size);
@@ -1647,32 +1803,39 @@ got_pack_dump_delta_chain_to_file(size_t *result_size,
 			/* Accumulated delta becomes the new base. */
 			if (base_buf) {
 				uint8_t *tmp = accum_buf;
-				size_t tmp_size = accum_bufsz;
 				accum_buf = base_buf;
-				accum_bufsz = base_bufsz;
 				base_buf = tmp;
-				base_bufsz = tmp_size;
+				base_bufsz = accum_size;
 			} else {
 				FILE *tmp = accum_file;
 				accum_file = base_file;
 				base_file = tmp;
 				rewind(base_file);
 				rewind(accum_file);
+				/* Drop the consumed base before reuse. */
+				if (ftruncate(fileno(accum_file), 0L) == -1) {
+					err = got_error_from_errno(
+					    "ftruncate");
+					goto done;
+				}
 			}
 		}
 	}
 
 done:
-	free(base_buf);
+	pack_scratch_put(pack, base_buf, max_size);
 	if (err) {
-		free(accum_buf);
+		pack_scratch_put(pack, accum_buf, max_size);
 		accum_buf = NULL;
 	}
 	if (accum_buf) {
-		size_t len = fwrite(accum_buf, 1, accum_size, outfile);
-		free(accum_buf);
-		if (len != accum_size)
-			err = got_ferror(outfile, GOT_ERR_IO);
+		if (!streamed) {
+			size_t len = fwrite(accum_buf, 1, accum_size,
+			    outfile);
+			if (len != accum_size)
+				err = got_ferror(outfile, GOT_ERR_IO);
+		}
+		pack_scratch_put(pack, accum_buf, max_size);
 	}
 	rewind(outfile);
 	if (err == NULL)
@@ -1687,21 +1850,22 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 	const struct got_error *err = NULL;
 	struct got_delta *delta;
 	uint8_t *base_buf = NULL, *accum_buf = NULL;
-	size_t base_bufsz = 0, accum_bufsz = 0, accum_size = 0;
+	size_t base_bufsz = 0, accum_size = 0;
 	uint64_t max_size = 0;
-	int n = 0;
+	int i, n = 0;
 
 	*outbuf = NULL;
 	*outlen = 0;
 
-	if (STAILQ_EMPTY(&deltas->entries))
+	if (deltas->nentries == 0)
 		return got_error(GOT_ERR_BAD_DELTA_CHAIN);
 
 	if (pack->delta_cache) {
 		uint8_t *delta_buf = NULL, *fulltext = NULL;
 		size_t delta_len, fulltext_len;
 
-		delta = STAILQ_LAST(&deltas->entries, got_delta, entry);
+		/* The delta target is the first entry in the chain. */
+		delta = &deltas->entries[0];
 		got_delta_cache_get(&delta_buf, &delta_len,
 		    &fulltext, &fulltext_len,
 		    pack->delta_cache, delta->data_offset);
@@ -1715,12 +1879,23 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 		}
 	}
 
-	/* Deltas are ordered in ascending order. */
-	STAILQ_FOREACH(delta, &deltas->entries, entry) {
+	/*
+	 * Compute the largest object size which occurs along the chain
+	 * and size our scratch buffers for it up front. This avoids
+	 * buffer growth, and the copying it implies, while deltas are
+	 * being applied. Delta data read along the way is added to the
+	 * delta cache and will usually be found there by the loop below.
+	 */
+	err = got_pack_get_delta_chain_max_size(&max_size, deltas, pack);
+	if (err)
+		return err;
+
+	/* Walk the chain from the delta base towards the delta target. */
+	for (i = deltas->nentries - 1; i >= 0; i--) {
 		uint8_t *delta_buf = NULL, *fulltext = NULL;
 		size_t delta_len, fulltext_len = 0;
-		uint64_t base_size, result_size = 0;
 		int cached = 1;
+		delta = &deltas->entries[i];
 		if (n == 0) {
 			off_t delta_data_offset;
 
@@ -1743,15 +1918,18 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 				got_delta_cache_get(&delta_buf, &delta_len,
 				    &fulltext, &fulltext_len,
 				    pack->delta_cache, delta_data_offset);
+				if (fulltext && fulltext_len > max_size) {
+					fulltext = NULL;
+					fulltext_len = 0;
+				}
 			}
 
-			if (delta->size > max_size)
-				max_size = delta->size;
-			if (delta->size > fulltext_len)
-				max_size = fulltext_len;
-
 			if (fulltext) {
-				base_buf = malloc(fulltext_len);
+				/*
+				 * Allocate the chain's maximum; this buffer
+				 * doubles as accumulation space later on.
+				 */
+				base_buf = pack_scratch_get(pack, max_size);
 				if (base_buf == NULL) {
 					err = got_error_from_errno("malloc");
 					goto done;
@@ -1770,8 +1948,9 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 
 				mapoff = delta_data_offset;
 				err = got_inflate_to_mem_mmap(&base_buf,
-				    &base_bufsz, NULL, NULL, pack->map,
-				    mapoff, pack->filesize - mapoff);
+				    &base_bufsz, NULL, NULL, max_size,
+				    pack->map, mapoff,
+				    pack->filesize - mapoff);
 			} else {
 				if (lseek(pack->fd, delta_data_offset, SEEK_SET)
 				    == -1) {
@@ -1815,7 +1994,7 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 		if (delta_buf == NULL) {
 			cached = 0;
 			err = read_delta_data(&delta_buf, &delta_len, NULL,
-			    delta->data_offset, pack);
+			    delta->size, delta->data_offset, pack);
 			if (err)
 				goto done;
 		}
@@ -1830,42 +2009,20 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 			}
 		}
 
-		err = got_delta_get_sizes(&base_size, &result_size,
-		    delta_buf, delta_len);
-		if (err) {
-			if (!cached)
-				free(delta_buf);
-			goto done;
-		}
-		if (base_size > max_size)
-			max_size = base_size;
-		if (result_size > max_size)
-			max_size = result_size;
-		if (fulltext_len > max_size)
-			max_size = fulltext_len;
-
-		if (max_size > base_bufsz) {
-			uint8_t *p = realloc(base_buf, max_size);
-			if (p == NULL) {
-				err = got_error_from_errno("realloc");
-				if (!cached)
-					free(delta_buf);
-				goto done;
-			}
-			base_buf = p;
-			base_bufsz = max_size;
+		/* The chain's maximum covers any cached fulltext. */
+		if (fulltext && fulltext_len > max_size) {
+			fulltext = NULL;
+			fulltext_len = 0;
 		}
 
-		if (max_size > accum_bufsz) {
-			uint8_t *p = realloc(accum_buf, max_size);
-			if (p == NULL) {
-				err = got_error_from_errno("realloc");
+		if (accum_buf == NULL) {
+			accum_buf = pack_scratch_get(pack, max_size);
+			if (accum_buf == NULL) {
+				err = got_error_from_errno("malloc");
 				if (!cached)
 					free(delta_buf);
 				goto done;
 			}
-			accum_buf = p;
-			accum_bufsz = max_size;
 		}
 
 		if (fulltext) {
@@ -1896,18 +2053,16 @@ got_pack_dump_delta_chain_to_mem(uint8_t **outbuf, size_t *outlen,
 		if (n < deltas->nentries) {
 			/* Accumulated delta becomes the new base. */
 			uint8_t *tmp = accum_buf;
-			size_t tmp_size = accum_bufsz;
 			accum_buf = base_buf;
-			accum_bufsz = base_bufsz;
 			base_buf = tmp;
-			base_bufsz = tmp_size;
+			base_bufsz = accum_size;
 		}
 	}
 
 done:
-	free(base_buf);
+	pack_scratch_put(pack, base_buf, max_size);
 	if (err) {
-		free(accum_buf);
+		pack_scratch_put(pack, accum_buf, max_size);
 		*outbuf = NULL;
 		*outlen = 0;
 	} else {
@@ -1979,7 +2134,8 @@ got_packfile_extract_object_to_mem(uint8_t **buf, size_t *len,
 
 			mapoff = obj->pack_offset;
 			err = got_inflate_to_mem_mmap(buf, len, NULL, NULL,
-			    pack->map, mapoff, pack->filesize - mapoff);
+			    obj->size, pack->map, mapoff,
+			    pack->filesize - mapoff);
 		} else {
 			if (lseek(pack->fd, obj->pack_offset, SEEK_SET) == -1)
 				return got_error_from_errno("lseek");
@@ -1996,13 +2152,14 @@ got_packfile_extract_object_to_mem(uint8_t **buf, size_t *len,
 static const struct got_error *
 read_raw_delta_data(uint8_t **delta_buf, size_t *delta_len,
     size_t *delta_len_compressed, uint64_t *base_size, uint64_t *result_size,
-    off_t delta_data_offset, struct got_pack *pack, struct got_packidx *packidx)
+    size_t expected_size, off_t delta_data_offset, struct got_pack *pack,
+    struct got_packidx *packidx)
 {
 	const struct got_error *err = NULL;
 
 	/* Validate decompression and obtain the decompressed size. */
 	err = read_delta_data(delta_buf, delta_len, delta_len_compressed,
-	    delta_data_offset, pack);
+	    expected_size, delta_data_offset, pack);
 	if (err)
 		return err;
 
@@ -2116,7 +2273,7 @@ got_packfile_extract_raw_delta(uint8_t **delta_buf, size_t *delta_size,
 
 	*delta_data_offset = offset + tslen + delta_hdrlen;
 	err = read_raw_delta_data(delta_buf, delta_size, delta_compressed_size,
-	    base_size, result_size, *delta_data_offset, pack, packidx);
+	    base_size, result_size, size, *delta_data_offset, pack, packidx);
 	if (err)
 		return err;
 
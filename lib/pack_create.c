@@ -495,7 +495,7 @@ got_pack_find_pack_for_reuse(struct got_packidx **best_packidx,
 		if (err)
 			break;
 
-		nobj = be32toh(packidx->hdr.fanout_table[0xff]);
+		nobj = packidx->nobj;
 		if (nobj > nobj_max) {
 			best_packidx_path = path_packidx;
 			nobj_max = nobj;
@@ -1139,7 +1139,7 @@ got_pack_find_pack_for_commit_painting(struct got_packidx **best_packidx,
 		if (err)
 			break;
 
-		nobj = be32toh(packidx->hdr.fanout_table[0xff]);
+		nobj = packidx->nobj;
 		if (nobj <= nobj_max)
 			continue;
 
@@ -1274,7 +1274,7 @@ find_pack_for_enumeration(struct got_packidx **best_packidx,
 		if (err)
 			break;
 
-		nobj = be32toh(packidx->hdr.fanout_table[0xff]);
+		nobj = packidx->nobj;
 		if (nobj <= nobj_max)
 			continue;
 
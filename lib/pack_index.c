@@ -204,8 +204,8 @@ read_packed_object(struct got_pack *pack, struct got_indexed_object *obj,
 		} else {
 			if (pack->map) {
 				err = got_inflate_to_mem_mmap(&data, &datalen,
-				    &obj->len, &csum, pack->map, mapoff,
-				    pack->filesize - mapoff);
+				    &obj->len, &csum, obj->size, pack->map,
+				    mapoff, pack->filesize - mapoff);
 			} else {
 				err = got_inflate_to_mem_fd(&data, &datalen,
 				    &obj->len, &csum, obj->size, pack->fd);
@@ -256,7 +256,7 @@ read_packed_object(struct got_pack *pack, struct got_indexed_object *obj,
 			    digest_len);
 			mapoff += digest_len;
 			err = got_inflate_to_mem_mmap(NULL, &datalen,
-			    &obj->len, &csum, pack->map, mapoff,
+			    &obj->len, &csum, 0, pack->map, mapoff,
 			    pack->filesize - mapoff);
 			if (err)
 				break;
@@ -313,7 +313,7 @@ read_packed_object(struct got_pack *pack, struct got_indexed_object *obj,
 			    obj->delta.ofs.base_offsetlen);
 			mapoff += obj->delta.ofs.base_offsetlen;
 			err = got_inflate_to_mem_mmap(NULL, &datalen,
-			    &obj->len, &csum, pack->map, mapoff,
+			    &obj->len, &csum, 0, pack->map, mapoff,
 			    pack->filesize - mapoff);
 			if (err)
 				break;
@@ -370,7 +370,6 @@ resolve_deltified_object(struct got_pack *pack, struct got_packidx *packidx,
 {
 	const struct got_error *err = NULL;
 	struct got_delta_chain deltas;
-	struct got_delta *delta;
 	uint8_t *buf = NULL;
 	size_t len = 0;
 	struct got_hash ctx;
@@ -380,8 +379,7 @@ resolve_deltified_object(struct got_pack *pack, struct got_packidx *packidx,
 	int base_obj_type;
 	const char *obj_label;
 
-	deltas.nentries = 0;
-	STAILQ_INIT(&deltas.entries);
+	memset(&deltas, 0, sizeof(deltas));
 
 	err = got_pack_resolve_delta_chain(&deltas, packidx, pack,
 	    obj->off, obj->tslen, obj->type, obj->size,
@@ -430,11 +428,7 @@ resolve_deltified_object(struct got_pack *pack, struct got_packidx *packidx,
 done:
 	free(buf);
 	free(header);
-	while (!STAILQ_EMPTY(&deltas.entries)) {
-		delta = STAILQ_FIRST(&deltas.entries);
-		STAILQ_REMOVE_HEAD(&deltas.entries, entry);
-		free(delta);
-	}
+	free(deltas.entries);
 	return err;
 }
 
@@ -319,6 +319,22 @@ done:
 	return err;
 }
 
+const struct got_error *
+got_path_join(char *buf, size_t bufsize, const char *parent,
+    const char *child)
+{
+	size_t parent_len = strlen(parent);
+	size_t child_len = strlen(child);
+
+	if (parent_len + 1 + child_len + 1 > bufsize)
+		return got_error_fmt(GOT_ERR_NO_SPACE, "%s/%s", parent, child);
+
+	memcpy(buf, parent, parent_len);
+	buf[parent_len] = '/';
+	memcpy(buf + parent_len + 1, child, child_len + 1);
+	return NULL;
+}
+
 const struct got_error *
 got_path_mkdir(const char *abspath)
 {
@@ -62,6 +62,8 @@
 #include "got_lib_repository.h"
 #include "got_lib_gotconfig.h"
 
+#include "murmurhash2.h"
+
 #ifndef nitems
 #define nitems(_a) (sizeof(_a) / sizeof((_a)[0]))
 #endif
@@ -1159,6 +1161,11 @@ done:
 	return err;
 }
 
+/*
+ * The cache takes ownership of the packidx. Lookups borrow the cached
+ * pointer directly; the immutable index data is never duplicated.
+ * Entries stay alive until evicted here or the repository is closed.
+ */
 static const struct got_error *
 cache_packidx(struct got_repository *repo, struct got_packidx *packidx,
     const char *path_packidx)
@@ -1169,7 +1176,8 @@ cache_packidx(struct got_repository *repo, struct got_packidx *packidx,
 	for (i = 0; i < repo->pack_cache_size; i++) {
 		if (repo->packidx_cache[i] == NULL)
 			break;
-		if (strcmp(repo->packidx_cache[i]->path_packidx,
+		if (repo->packidx_cache[i]->path_hash == packidx->path_hash &&
+		    strcmp(repo->packidx_cache[i]->path_packidx,
 		    path_packidx) == 0) {
 			return got_error(GOT_ERR_CACHE_DUP_ENTRY);
 		}
@@ -1197,14 +1205,20 @@ got_repo_is_packidx_filename(const char *name, size_t len,
 
 	digest_string_len = got_hash_digest_string_length(algo);
 
+	/*
+	 * This runs for every directory entry seen while scanning the
+	 * pack directory. Check the cheap length requirement first, and
+	 * compare prefix and suffix with constant lengths which compilers
+	 * can turn into word-sized compares.
+	 */
 	if (len != GOT_PACKIDX_NAMELEN(digest_string_len))
 		return 0;
 
-	if (strncmp(name, GOT_PACK_PREFIX, strlen(GOT_PACK_PREFIX)) != 0)
+	if (memcmp(name, GOT_PACK_PREFIX, strlen(GOT_PACK_PREFIX)) != 0)
 		return 0;
 
-	if (strcmp(name + strlen(GOT_PACK_PREFIX) + digest_string_len - 1,
-	    GOT_PACKIDX_SUFFIX) != 0)
+	if (memcmp(name + len - strlen(GOT_PACKIDX_SUFFIX),
+	    GOT_PACKIDX_SUFFIX, strlen(GOT_PACKIDX_SUFFIX)) != 0)
 		return 0;
 
 	return 1;
@@ -1243,7 +1257,7 @@ static const struct got_error *
 add_packidx_bloom_filter(struct got_repository *repo,
     struct got_packidx *packidx, const char *path_packidx)
 {
-	int i, nobjects = be32toh(packidx->hdr.fanout_table[0xff]);
+	int i, nobjects = packidx->nobj;
 	struct got_packidx_bloom_filter *bf;
 	size_t len, digest_len;
 
@@ -1428,6 +1442,24 @@ done:
 	return err;
 }
 
+struct got_packidx_path_info {
+	char *path;
+	off_t size;
+};
+
+static int
+packidx_path_info_cmp(const void *pa, const void *pb)
+{
+	const struct got_packidx_path_info *a = pa, *b = pb;
+
+	/* Sort large pack index files first. */
+	if (a->size > b->size)
+		return -1;
+	if (a->size < b->size)
+		return 1;
+	return strcmp(a->path, b->path);
+}
+
 const struct got_error *
 got_repo_list_packidx(struct got_pathlist_head *packidx_paths,
     struct got_repository *repo)
@@ -1436,6 +1468,8 @@ got_repo_list_packidx(struct got_pathlist_head *packidx_paths,
 	DIR *packdir = NULL;
 	struct dirent *dent;
 	char *path_packidx = NULL;
+	struct got_packidx_path_info *paths = NULL;
+	size_t npaths = 0, maxpaths = 0, i;
 	int packdir_fd;
 	struct stat sb;
 
@@ -1467,6 +1501,11 @@ got_repo_list_packidx(struct got_pathlist_head *packidx_paths,
 		    repo->algo))
 			continue;
 
+		if (fstatat(packdir_fd, dent->d_name, &sb, 0) == -1) {
+			err = got_error_from_errno2("fstatat", dent->d_name);
+			break;
+		}
+
 		if (asprintf(&path_packidx, "%s/%s", GOT_OBJECTS_PACK_DIR,
 		    dent->d_name) == -1) {
 			err = got_error_from_errno("asprintf");
@@ -1474,13 +1513,45 @@ got_repo_list_packidx(struct got_pathlist_head *packidx_paths,
 			break;
 		}
 
-		err = got_pathlist_append(packidx_paths, path_packidx, NULL);
+		if (npaths == maxpaths) {
+			struct got_packidx_path_info *new;
+			size_t n = maxpaths ? maxpaths * 2 : 8;
+			new = reallocarray(paths, n, sizeof(*paths));
+			if (new == NULL) {
+				err = got_error_from_errno("reallocarray");
+				break;
+			}
+			paths = new;
+			maxpaths = n;
+		}
+		paths[npaths].path = path_packidx;
+		paths[npaths].size = sb.st_size;
+		npaths++;
+		path_packidx = NULL;
+	}
+	if (err)
+		goto done;
+
+	/*
+	 * Sort pack index files by size in descending order. The largest
+	 * pack usually contains the most objects, so searching it first
+	 * makes object lookups terminate sooner on average.
+	 */
+	qsort(paths, npaths, sizeof(paths[0]), packidx_path_info_cmp);
+
+	for (i = 0; i < npaths; i++) {
+		err = got_pathlist_append(packidx_paths, paths[i].path, NULL);
 		if (err)
-			break;
+			goto done;
+		paths[i].path = NULL;
 	}
 done:
-	if (err)
+	if (err) {
 		free(path_packidx);
+		for (i = 0; i < npaths; i++)
+			free(paths[i].path);
+	}
+	free(paths);
 	if (packdir && closedir(packdir) != 0 && err == NULL)
 		err = got_error_from_errno("closedir");
 	return err;
@@ -1529,7 +1600,6 @@ static const struct got_error *
 read_packfile_hdr(int fd, struct got_packidx *packidx)
 {
 	const struct got_error *err = NULL;
-	uint32_t totobj = be32toh(packidx->hdr.fanout_table[0xff]);
 	struct got_packfile_hdr hdr;
 	ssize_t n;
 
@@ -1539,9 +1609,15 @@ read_packfile_hdr(int fd, struct got_packidx *packidx)
 	if (n != sizeof(hdr))
 		return got_error(GOT_ERR_BAD_PACKFILE);
 
-	if (be32toh(hdr.signature) != GOT_PACKFILE_SIGNATURE ||
-	    be32toh(hdr.version) != GOT_PACKFILE_VERSION ||
-	    be32toh(hdr.nobjects) != totobj)
+	/*
+	 * Compare in big-endian form: the expected signature and
+	 * version become compile-time constants and the object count
+	 * matches the fanout table's on-disk representation, so no
+	 * byteswaps are needed.
+	 */
+	if (hdr.signature != htobe32(GOT_PACKFILE_SIGNATURE) ||
+	    hdr.version != htobe32(GOT_PACKFILE_VERSION) ||
+	    hdr.nobjects != packidx->hdr.fanout_table[0xff])
 		err = got_error(GOT_ERR_BAD_PACKFILE);
 
 	return err;
@@ -1578,16 +1654,21 @@ got_repo_cache_pack(struct got_pack **packp, struct got_repository *repo,
 	struct got_pack *pack = NULL;
 	struct got_pack tmp;
 	struct stat sb;
+	uint32_t path_hash;
 	size_t i;
 
 	if (packp)
 		*packp = NULL;
 
+	path_hash = murmurhash2(path_packfile, strlen(path_packfile),
+	    GOT_PACK_PATH_HASH_SEED);
+
 	for (i = 0; i < repo->pack_cache_size; i++) {
 		pack = &repo->packs[i];
 		if (pack->path_packfile == NULL)
 			break;
-		if (strcmp(pack->path_packfile, path_packfile) == 0)
+		if (pack->path_hash == path_hash &&
+		    strcmp(pack->path_packfile, path_packfile) == 0)
 			return got_error(GOT_ERR_CACHE_DUP_ENTRY);
 	}
 
@@ -1624,6 +1705,7 @@ got_repo_cache_pack(struct got_pack **packp, struct got_repository *repo,
 		err = got_error_from_errno("strdup");
 		goto done;
 	}
+	pack->path_hash = path_hash;
 
 	err = open_packfile(&pack->fd, repo, path_packfile, packidx);
 	if (err)
@@ -1652,6 +1734,14 @@ got_repo_cache_pack(struct got_pack **packp, struct got_repository *repo,
 				goto done;
 			}
 			pack->map = NULL; /* fall back to read(2) */
+		} else {
+			/*
+			 * Delta chains jump between scattered offsets
+			 * within the pack; sequential readahead around
+			 * each fault is wasted effort.
+			 */
+			(void)posix_madvise(pack->map, pack->filesize,
+			    POSIX_MADV_RANDOM);
 		}
 	}
 #endif
@@ -1664,8 +1754,9 @@ done:
 	return err;
 }
 
-struct got_pack *
-got_repo_get_cached_pack(struct got_repository *repo, const char *path_packfile)
+static struct got_pack *
+get_cached_pack(struct got_repository *repo, const char *path_packfile,
+    uint32_t path_hash)
 {
 	struct got_pack *pack = NULL;
 	size_t i;
@@ -1674,13 +1765,45 @@ got_repo_get_cached_pack(struct got_repository *repo, const char *path_packfile)
 		pack = &repo->packs[i];
 		if (pack->path_packfile == NULL)
 			break;
-		if (strcmp(pack->path_packfile, path_packfile) == 0)
+		if (pack->path_hash == path_hash &&
+		    strcmp(pack->path_packfile, path_packfile) == 0)
 			return pack;
 	}
 
 	return NULL;
 }
 
+struct got_pack *
+got_repo_get_cached_pack(struct got_repository *repo, const char *path_packfile)
+{
+	return get_cached_pack(repo, path_packfile,
+	    murmurhash2(path_packfile, strlen(path_packfile),
+	    GOT_PACK_PATH_HASH_SEED));
+}
+
+/*
+ * Return the open pack file corresponding to a pack index, opening
+ * and caching it first if necessary. Uses the pack file path derived
+ * when the index was opened, avoiding a path allocation per call.
+ */
+const struct got_error *
+got_repo_get_pack_for_packidx(struct got_pack **packp,
+    struct got_repository *repo, struct got_packidx *packidx)
+{
+	struct got_pack *pack;
+
+	/* The pack index already carries the hash of this path. */
+	pack = get_cached_pack(repo, packidx->path_packfile,
+	    packidx->path_packfile_hash);
+	if (pack != NULL) {
+		*packp = pack;
+		return NULL;
+	}
+
+	return got_repo_cache_pack(packp, repo, packidx->path_packfile,
+	    packidx);
+}
+
 const struct got_error *
 got_repo_pin_pack(struct got_repository *repo, struct got_packidx *packidx,
     struct got_pack *pack)
@@ -2093,11 +2216,41 @@ got_repo_match_object_id(struct got_object_id **id, char **label,
 	const struct got_error *err;
 	struct got_tag_object *tag;
 	struct got_reference *ref = NULL;
+	size_t len;
 
 	*id = NULL;
 	if (label)
 		*label = NULL;
 
+	/*
+	 * Check for a full-length hex object ID first. This avoids
+	 * tag and reference lookups, which can involve disk I/O, for
+	 * the common case where a command is given an ID obtained
+	 * from earlier got output.
+	 */
+	len = strlen(id_str);
+	if (len == got_hash_digest_string_length(repo->algo) - 1) {
+		const char *p = id_str;
+
+		while (isxdigit((unsigned char)*p))
+			p++;
+		if (*p == '\0') {
+			err = got_repo_match_object_id_prefix(id, id_str,
+			    obj_type, repo);
+			if (err == NULL) {
+				if (label)
+					err = got_object_id_str(label, *id);
+				return err;
+			}
+			if (err->code != GOT_ERR_NO_OBJ)
+				return err;
+			/*
+			 * No such object; fall back to matching tag
+			 * and reference names as before.
+			 */
+		}
+	}
+
 	if (refs) {
 		err = got_repo_object_match_tag(&tag, id_str, obj_type,
 		    refs, repo);
@@ -2571,7 +2724,6 @@ got_repo_get_packfile_info(int *npackfiles, int *nobjects,
 	struct dirent *dent;
 	struct got_packidx *packidx = NULL;
 	char *path_packidx;
-	char *path_packfile;
 	int packdir_fd;
 	struct stat sb;
 
@@ -2621,20 +2773,12 @@ got_repo_get_packfile_info(int *npackfiles, int *nobjects,
 			goto done;
 		*total_packsize += sb.st_size;
 
-		err = got_packidx_get_packfile_path(&path_packfile,
-		    packidx->path_packidx);
-		if (err)
-			goto done;
-
-		if (fstatat(got_repo_get_fd(repo), path_packfile, &sb,
-		    0) == -1) {
-			free(path_packfile);
+		if (fstatat(got_repo_get_fd(repo), packidx->path_packfile,
+		    &sb, 0) == -1)
 			goto done;
-		}
-		free(path_packfile);
 		*total_packsize += sb.st_size;
 
-		*nobjects += be32toh(packidx->hdr.fanout_table[0xff]);
+		*nobjects += packidx->nobj;
 
 		(*npackfiles)++;
 
@@ -553,7 +553,7 @@ got_repo_list_pack(FILE *packfile, struct got_object_id *pack_hash,
 	if (err)
 		goto done;
 
-	nobj = be32toh(packidx->hdr.fanout_table[0xff]);
+	nobj = packidx->nobj;
 	for (i = 0; i < nobj; i++) {
 		uint8_t *oid;
 		struct got_object_id id, base_id;
@@ -1278,7 +1278,7 @@ pack_is_redundant(int *redundant, struct got_repository *repo,
 	if (err)
 		return err;
 
-	nobjects = be32toh(packidx->hdr.fanout_table[0xff]);
+	nobjects = packidx->nobj;
 	for (i = 0; i < nobjects; ++i) {
 		pid = packidx->hdr.sorted_ids + i * digest_len;
 
@@ -1356,7 +1356,7 @@ repo_purge_redundant_packfiles(struct got_repository *repo,
 
 		pinfo = &sorted[i++];
 		pinfo->path = pe->path;
-		pinfo->nobjects = be32toh(packidx->hdr.fanout_table[0xff]);
+		pinfo->nobjects = packidx->nobj;
 	}
 	qsort(sorted, npacks, sizeof(*sorted), pack_info_cmp);
 
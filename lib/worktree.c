@@ -18,6 +18,7 @@
 
 #include <sys/stat.h>
 #include <sys/queue.h>
+#include <sys/uio.h>
 
 #include <dirent.h>
 #include <limits.h>
@@ -62,6 +63,13 @@
 #define GOT_MERGE_LABEL_MERGED	"merged change"
 #define GOT_MERGE_LABEL_BASE	"3-way merge base"
 
+/*
+ * Block size used while streaming blob content into files on disk.
+ * A larger block keeps the number of read/write syscalls per installed
+ * file low when checking out or updating many files.
+ */
+#define GOT_WORKTREE_BLOB_BLOCKSIZE	(64 * 1024)
+
 static mode_t
 apply_umask(mode_t mode)
 {
@@ -73,16 +81,39 @@ apply_umask(mode_t mode)
 }
 
 static const struct got_error *
-create_meta_file(const char *path_got, const char *name, const char *content)
+create_meta_file(int dir_fd, const char *path_got, const char *name,
+    const char *content)
 {
 	const struct got_error *err = NULL;
-	char *path;
+	int fd = -1;
 
-	if (asprintf(&path, "%s/%s", path_got, name) == -1)
-		return got_error_from_errno("asprintf");
+	fd = openat(dir_fd, name,
+	    O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+	    GOT_DEFAULT_FILE_MODE);
+	if (fd == -1) {
+		err = got_error_from_errno_fmt("open %s/%s", path_got, name);
+		goto done;
+	}
 
-	err = got_path_create_file(path, content);
-	free(path);
+	if (content) {
+		/* Write content and trailing newline with one syscall. */
+		struct iovec iov[2];
+		size_t len = strlen(content);
+		ssize_t n;
+
+		iov[0].iov_base = (void *)content;
+		iov[0].iov_len = len;
+		iov[1].iov_base = (void *)"\n";
+		iov[1].iov_len = 1;
+		n = writev(fd, iov, 2);
+		if (n == -1 || (size_t)n != len + 1) {
+			err = got_error_from_errno("writev");
+			goto done;
+		}
+	}
+done:
+	if (fd != -1 && close(fd) == -1 && err == NULL)
+		err = got_error_from_errno("close");
 	return err;
 }
 
@@ -154,11 +185,12 @@ got_worktree_init(const char *path, struct got_reference *head_ref,
 	uuid_t uuid;
 	uint32_t uuid_status;
 	int obj_type;
-	char *path_got = NULL;
+	char path_got[PATH_MAX];
 	char *formatstr = NULL;
 	char *absprefix = NULL;
 	char *basestr = NULL;
 	char *uuidstr = NULL;
+	int got_fd = -1;
 
 	if (strcmp(path, got_repo_get_path(repo)) == 0) {
 		err = got_error(GOT_ERR_WORKTREE_REPO);
@@ -186,22 +218,28 @@ got_worktree_init(const char *path, struct got_reference *head_ref,
 	}
 
 	/* Create .got/.cvg directory (may already exist). */
-	if (asprintf(&path_got, "%s/%s", path, meta_dir) == -1) {
-		err = got_error_from_errno("asprintf");
+	err = got_path_join(path_got, sizeof(path_got), path, meta_dir);
+	if (err)
 		goto done;
-	}
 	if (mkdir(path_got, GOT_DEFAULT_DIR_MODE) == -1 && errno != EEXIST) {
 		err = got_error_from_errno2("mkdir", path_got);
 		goto done;
 	}
 
+	/* Meta files are created relative to this directory. */
+	got_fd = open(path_got, O_DIRECTORY | O_CLOEXEC);
+	if (got_fd == -1) {
+		err = got_error_from_errno2("open", path_got);
+		goto done;
+	}
+
 	/* Create an empty lock file. */
-	err = create_meta_file(path_got, GOT_WORKTREE_LOCK, NULL);
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_LOCK, NULL);
 	if (err)
 		goto done;
 
 	/* Create an empty file index. */
-	err = create_meta_file(path_got, GOT_WORKTREE_FILE_INDEX, NULL);
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_FILE_INDEX, NULL);
 	if (err)
 		goto done;
 
@@ -214,18 +252,19 @@ got_worktree_init(const char *path, struct got_reference *head_ref,
 	err = got_object_id_str(&basestr, commit_id);
 	if (err)
 		goto done;
-	err = create_meta_file(path_got, GOT_WORKTREE_BASE_COMMIT, basestr);
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_BASE_COMMIT,
+	    basestr);
 	if (err)
 		goto done;
 
 	/* Store path to repository. */
-	err = create_meta_file(path_got, GOT_WORKTREE_REPOSITORY,
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_REPOSITORY,
 	    got_repo_get_path(repo));
 	if (err)
 		goto done;
 
 	/* Store in-repository path prefix. */
-	err = create_meta_file(path_got, GOT_WORKTREE_PATH_PREFIX,
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_PATH_PREFIX,
 	    absprefix ? absprefix : prefix);
 	if (err)
 		goto done;
@@ -241,7 +280,7 @@ got_worktree_init(const char *path, struct got_reference *head_ref,
 		err = got_error_uuid(uuid_status, "uuid_to_string");
 		goto done;
 	}
-	err = create_meta_file(path_got, GOT_WORKTREE_UUID, uuidstr);
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_UUID, uuidstr);
 	if (err)
 		goto done;
 
@@ -250,13 +289,15 @@ got_worktree_init(const char *path, struct got_reference *head_ref,
 		err = got_error_from_errno("asprintf");
 		goto done;
 	}
-	err = create_meta_file(path_got, GOT_WORKTREE_FORMAT, formatstr);
+	err = create_meta_file(got_fd, path_got, GOT_WORKTREE_FORMAT,
+	    formatstr);
 	if (err)
 		goto done;
 
 done:
+	if (got_fd != -1 && close(got_fd) == -1 && err == NULL)
+		err = got_error_from_errno2("close", path_got);
 	free(commit_id);
-	free(path_got);
 	free(formatstr);
 	free(absprefix);
 	free(basestr);
@@ -2034,7 +2075,8 @@ update_blob(struct got_worktree *worktree,
 		err = got_error_from_errno("got_opentempfd");
 		goto done;
 	}
-	err = got_object_open_as_blob(&blob, repo, &te->id, 8192, fd1);
+	err = got_object_open_as_blob(&blob, repo, &te->id,
+	    GOT_WORKTREE_BLOB_BLOCKSIZE, fd1);
 	if (err)
 		goto done;
 
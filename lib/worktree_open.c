@@ -45,66 +45,58 @@
 #endif
 
 static const struct got_error *
-read_meta_file(char **content, const char *path_got, const char *name)
+read_meta_file(char **content, int dir_fd, const char *path_got,
+    const char *name)
 {
 	const struct got_error *err = NULL;
-	char *path;
 	int fd = -1;
 	ssize_t n;
-	struct stat sb;
+	char buf[PATH_MAX];
 
 	*content = NULL;
 
-	if (asprintf(&path, "%s/%s", path_got, name) == -1) {
-		err = got_error_from_errno("asprintf");
-		path = NULL;
-		goto done;
-	}
-
-	fd = open(path, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+	fd = openat(dir_fd, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
 	if (fd == -1) {
 		if (errno == ENOENT)
-			err = got_error_path(path, GOT_ERR_WORKTREE_META);
+			err = got_error_fmt(GOT_ERR_WORKTREE_META,
+			    "%s/%s", path_got, name);
 		else
-			err = got_error_from_errno2("open", path);
+			err = got_error_from_errno_fmt("open %s/%s",
+			    path_got, name);
 		goto done;
 	}
 	if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
 		err = (errno == EWOULDBLOCK ? got_error(GOT_ERR_WORKTREE_BUSY)
-		    : got_error_from_errno2("flock", path));
+		    : got_error_from_errno_fmt("flock %s/%s", path_got, name));
 		goto done;
 	}
 
-	if (fstat(fd, &sb) != 0) {
-		err = got_error_from_errno2("fstat", path);
+	/*
+	 * Meta files hold a single line: a version number, a path, an
+	 * object ID, a UUID, or a reference name. One read into a stack
+	 * buffer covers them all and spares the fstat and the sized
+	 * heap allocation; anything which fills the buffer is corrupt.
+	 */
+	n = read(fd, buf, sizeof(buf));
+	if (n == -1) {
+		err = got_error_from_errno_fmt("read %s/%s", path_got, name);
 		goto done;
 	}
-	if (sb.st_size == 0) {
-		err = got_error_path(path, GOT_ERR_WORKTREE_META);
-		goto done;
-	}
-	*content = calloc(1, sb.st_size);
-	if (*content == NULL) {
-		err = got_error_from_errno("calloc");
+	if (n == 0 || n == sizeof(buf) || buf[n - 1] != '\n') {
+		err = got_error_fmt(GOT_ERR_WORKTREE_META,
+		    "%s/%s", path_got, name);
 		goto done;
 	}
+	buf[n - 1] = '\0';
 
-	n = read(fd, *content, sb.st_size);
-	if (n != sb.st_size) {
-		err = (n == -1 ? got_error_from_errno2("read", path) :
-		    got_error_path(path, GOT_ERR_WORKTREE_META));
-		goto done;
-	}
-	if ((*content)[sb.st_size - 1] != '\n') {
-		err = got_error_path(path, GOT_ERR_WORKTREE_META);
+	*content = strdup(buf);
+	if (*content == NULL) {
+		err = got_error_from_errno("strdup");
 		goto done;
 	}
-	(*content)[sb.st_size - 1] = '\0';
-
 done:
 	if (fd != -1 && close(fd) == -1 && err == NULL)
 		err = got_error_from_errno2("close", path_got);
-	free(path);
 	if (err) {
 		free(*content);
 		*content = NULL;
@@ -117,12 +109,12 @@ open_worktree(struct got_worktree **worktree, const char *path,
     const char *meta_dir)
 {
 	const struct got_error *err = NULL;
-	char *path_meta;
+	char path_meta[PATH_MAX];
+	char path_lock[PATH_MAX];
 	char *formatstr = NULL;
 	char *uuidstr = NULL;
-	char *path_lock = NULL;
 	char *base_commit_id_str = NULL;
-	int version, fd = -1;
+	int version, fd = -1, meta_fd = -1;
 	const char *errstr;
 	struct got_repository *repo = NULL;
 	int *pack_fds = NULL;
@@ -130,17 +122,14 @@ open_worktree(struct got_worktree **worktree, const char *path,
 
 	*worktree = NULL;
 
-	if (asprintf(&path_meta, "%s/%s", path, meta_dir) == -1) {
-		err = got_error_from_errno("asprintf");
-		path_meta = NULL;
+	err = got_path_join(path_meta, sizeof(path_meta), path, meta_dir);
+	if (err)
 		goto done;
-	}
 
-	if (asprintf(&path_lock, "%s/%s", path_meta, GOT_WORKTREE_LOCK) == -1) {
-		err = got_error_from_errno("asprintf");
-		path_lock = NULL;
+	err = got_path_join(path_lock, sizeof(path_lock), path_meta,
+	    GOT_WORKTREE_LOCK);
+	if (err)
 		goto done;
-	}
 
 	fd = open(path_lock, O_RDWR | O_EXLOCK | O_NONBLOCK | O_CLOEXEC);
 	if (fd == -1) {
@@ -149,7 +138,15 @@ open_worktree(struct got_worktree **worktree, const char *path,
 		goto done;
 	}
 
-	err = read_meta_file(&formatstr, path_meta, GOT_WORKTREE_FORMAT);
+	/* All meta files live here; resolve the directory just once. */
+	meta_fd = open(path_meta, O_DIRECTORY | O_CLOEXEC);
+	if (meta_fd == -1) {
+		err = got_error_from_errno2("open", path_meta);
+		goto done;
+	}
+
+	err = read_meta_file(&formatstr, meta_fd, path_meta,
+	    GOT_WORKTREE_FORMAT);
 	if (err)
 		goto done;
 
@@ -178,22 +175,23 @@ open_worktree(struct got_worktree **worktree, const char *path,
 		goto done;
 	}
 	(*worktree)->meta_dir = meta_dir;
-	err = read_meta_file(&(*worktree)->repo_path, path_meta,
+	err = read_meta_file(&(*worktree)->repo_path, meta_fd, path_meta,
 	    GOT_WORKTREE_REPOSITORY);
 	if (err)
 		goto done;
 
-	err = read_meta_file(&(*worktree)->path_prefix, path_meta,
+	err = read_meta_file(&(*worktree)->path_prefix, meta_fd, path_meta,
 	    GOT_WORKTREE_PATH_PREFIX);
 	if (err)
 		goto done;
 
-	err = read_meta_file(&base_commit_id_str, path_meta,
+	err = read_meta_file(&base_commit_id_str, meta_fd, path_meta,
 	    GOT_WORKTREE_BASE_COMMIT);
 	if (err)
 		goto done;
 
-	err = read_meta_file(&uuidstr, path_meta, GOT_WORKTREE_UUID);
+	err = read_meta_file(&uuidstr, meta_fd, path_meta,
+	    GOT_WORKTREE_UUID);
 	if (err)
 		goto done;
 	uuid_from_string(uuidstr, &(*worktree)->uuid, &uuid_status);
@@ -215,7 +213,7 @@ open_worktree(struct got_worktree **worktree, const char *path,
 	if (err)
 		goto done;
 
-	err = read_meta_file(&(*worktree)->head_ref_name, path_meta,
+	err = read_meta_file(&(*worktree)->head_ref_name, meta_fd, path_meta,
 	    GOT_WORKTREE_HEAD_REF);
 	if (err)
 		goto done;
@@ -250,8 +248,8 @@ done:
 		if (err == NULL)
 			err = pack_err;
 	}
-	free(path_meta);
-	free(path_lock);
+	if (meta_fd != -1 && close(meta_fd) == -1 && err == NULL)
+		err = got_error_from_errno2("close", path_meta);
 	free(base_commit_id_str);
 	free(uuidstr);
 	free(formatstr);
@@ -1166,6 +1166,9 @@ receive_packidx(struct got_packidx **packidx, struct imsgbuf *ibuf)
 		p->map = mmap(NULL, p->len, PROT_READ, MAP_PRIVATE, p->fd, 0);
 		if (p->map == MAP_FAILED)
 			p->map = NULL; /* fall back to read(2) */
+		else
+			(void)posix_madvise(p->map, p->len,
+			    POSIX_MADV_RANDOM);
 	}
 #endif
 	err = got_packidx_init_hdr(p, 1, ipackidx.packfile_size);
@@ -1958,6 +1961,15 @@ receive_pack(struct got_pack **packp, struct imsgbuf *ibuf)
 		    pack->fd, 0);
 		if (pack->map == MAP_FAILED)
 			pack->map = NULL; /* fall back to read(2) */
+		else {
+			/*
+			 * Delta chains jump between scattered offsets
+			 * within the pack; sequential readahead around
+			 * each fault is wasted effort.
+			 */
+			(void)posix_madvise(pack->map, pack->filesize,
+			    POSIX_MADV_RANDOM);
+		}
 	}
 #endif
 done:
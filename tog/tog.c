@@ -134,10 +134,17 @@ enum tog_view_mode {
 
 #define TOG_EOF_STRING	"(END)"
 
+/* Number of commits to load ahead of the last displayed commit. */
+#define TOG_LOG_PREFETCH	32
+
 struct commit_queue_entry {
 	TAILQ_ENTRY(commit_queue_entry) entry;
-	struct got_object_id *id;
+	struct got_object_id id;
+	char *id_str;
 	struct got_commit_object *commit;
+	char *author;		/* name part only, filled in on first draw */
+	char *committer;	/* likewise */
+	char *logmsg;		/* first line only, filled in on first draw */
 	int idx;
 };
 TAILQ_HEAD(commit_queue_head, commit_queue_entry);
@@ -200,6 +207,44 @@ tog_load_refs(struct got_repository *repo, int sort_by_date)
 	    repo);
 }
 
+/*
+ * Resolve a reference name via the list loaded by tog_load_refs(),
+ * if possible. Commands resolve their start commit right after
+ * loading this list; opening the same reference again from disk
+ * just to resolve it would repeat work got_ref_list() already did.
+ * Sets *id to NULL if the name is not on the list.
+ */
+static const struct got_error *
+tog_resolve_cached_ref(struct got_object_id **id, char **label,
+    const char *refname, struct got_repository *repo)
+{
+	const struct got_error *err;
+	struct got_reflist_entry *re;
+
+	*id = NULL;
+	if (label)
+		*label = NULL;
+
+	TAILQ_FOREACH(re, &tog_refs, entry) {
+		if (strcmp(got_ref_get_name(re->ref), refname) != 0)
+			continue;
+		err = got_ref_resolve(id, repo, re->ref);
+		if (err)
+			return err;
+		if (label) {
+			*label = strdup(refname);
+			if (*label == NULL) {
+				free(*id);
+				*id = NULL;
+				return got_error_from_errno("strdup");
+			}
+		}
+		break;
+	}
+
+	return NULL;
+}
+
 static void
 tog_free_refs(void)
 {
@@ -413,6 +458,9 @@ struct tog_log_view_state {
 	int limit_view;
 	regex_t limit_regex;
 	struct commit_queue limit_commits;
+	int author_cols;	/* width used during the last full redraw */
+	int selection_only_redraw;
+	int prev_selected;	/* valid when selection_only_redraw is set */
 };
 
 #define TOG_COLOR_DIFF_MINUS		1
@@ -2143,6 +2191,22 @@ view_loop(struct tog_view *view)
 			view = new_view;
 		}
 		if (view && !done) {
+			if (!using_mock_io) {
+				int nch;
+
+				/*
+				 * Coalesce redraws while input is arriving
+				 * faster than we repaint, e.g. during key
+				 * auto-repeat: if another key is already
+				 * pending, process it first and draw once
+				 * the input queue has drained.
+				 */
+				nodelay(view->window, TRUE);
+				nch = wgetch(view->window);
+				nodelay(view->window, FALSE);
+				if (nch != ERR && ungetch(nch) != ERR)
+					continue;
+			}
 			if (view_is_parent_view(view)) {
 				if (view->child && view->child->focussed)
 					view = view->child;
@@ -2454,6 +2518,88 @@ format_author(wchar_t **wauthor, int *author_width, char *author, int limit,
 	    col_tab_align, 0);
 }
 
+/*
+ * Return the name part of the author or committer of the entry's commit.
+ * The result is cached on the entry; redraws need it for every visible
+ * commit on every keystroke, and the commit itself never changes.
+ */
+static const struct got_error *
+get_display_author(char **author, struct commit_queue_entry *entry,
+    int use_committer)
+{
+	char **cached;
+	char *name;
+	const char *from, *smallerthan;
+
+	cached = use_committer ? &entry->committer : &entry->author;
+	if (*cached == NULL) {
+		if (use_committer)
+			from = got_object_commit_get_committer(entry->commit);
+		else
+			from = got_object_commit_get_author(entry->commit);
+		smallerthan = strchr(from, '<');
+		if (smallerthan && smallerthan[1] != '\0')
+			from = smallerthan + 1;
+		name = strdup(from);
+		if (name == NULL)
+			return got_error_from_errno("strdup");
+		name[strcspn(name, "@>")] = '\0';
+		*cached = name;
+	}
+
+	*author = *cached;
+	return NULL;
+}
+
+/*
+ * Return the first line of the log message of the entry's commit,
+ * cached on the entry for the same reason as the author above;
+ * assembling the full log message allocates and copies every time.
+ */
+static const struct got_error *
+get_display_logmsg(char **logmsg, struct commit_queue_entry *entry)
+{
+	if (entry->logmsg == NULL) {
+		const struct got_error *err;
+		char *logmsg0, *line, *newline;
+
+		err = got_object_commit_get_logmsg(&logmsg0, entry->commit);
+		if (err)
+			return err;
+		line = logmsg0;
+		while (*line == '\n')
+			line++;
+		newline = strchr(line, '\n');
+		if (newline)
+			*newline = '\0';
+		entry->logmsg = strdup(line);
+		free(logmsg0);
+		if (entry->logmsg == NULL)
+			return got_error_from_errno("strdup");
+	}
+
+	*logmsg = entry->logmsg;
+	return NULL;
+}
+
+/*
+ * Pad the current row with n blank characters. A single waddnstr()
+ * call advances the cursor just like n separate waddch() calls but
+ * avoids the per-character call overhead while padding whole rows.
+ */
+static void
+waddblanks(WINDOW *window, int n)
+{
+	static const char blanks[] = "                                ";
+
+	while (n > 0) {
+		int len = MIN(n, (int)sizeof(blanks) - 1);
+
+		waddnstr(window, blanks, len);
+		n -= len;
+	}
+}
+
 static const struct got_error *
 draw_commit_marker(struct tog_view *view, char c)
 {
@@ -2480,14 +2626,13 @@ draw_commit(struct tog_view *view, struct commit_queue_entry *entry,
 	struct tog_log_view_state *s = &view->state.log;
 	const struct got_error *err = NULL;
 	struct got_commit_object *commit = entry->commit;
-	struct got_object_id *id = entry->id;
+	struct got_object_id *id = &entry->id;
 	char datebuf[12]; /* YYYY-MM-DD + SPACE + NUL */
 	char *refs_str = NULL;
-	char *logmsg0 = NULL, *logmsg = NULL;
+	char *logmsg = NULL;
 	char *author = NULL;
 	wchar_t *wrefstr = NULL, *wlogmsg = NULL, *wauthor = NULL;
 	int author_width, refstr_width, logmsg_width;
-	char *newline, *line = NULL;
 	int col, limit, scrollx, logmsg_x;
 	const int avail = view->ncols, marker_column = author_display_cols + 1;
 	struct tm tm;
@@ -2529,32 +2674,23 @@ draw_commit(struct tog_view *view, struct commit_queue_entry *entry,
 		goto done;
 
 	if (avail >= 120) {
-		char *id_str;
-		err = got_object_id_str(&id_str, id);
-		if (err)
-			goto done;
 		tc = get_color(&s->colors, TOG_COLOR_COMMIT);
 		if (tc)
 			wattr_on(view->window,
 			    COLOR_PAIR(tc->colorpair), NULL);
-		wprintw(view->window, "%.8s ", id_str);
+		waddnstr(view->window, entry->id_str, 8);
+		waddch(view->window, ' ');
 		if (tc)
 			wattr_off(view->window,
 			    COLOR_PAIR(tc->colorpair), NULL);
-		free(id_str);
 		col += 9;
 		if (col > avail)
 			goto done;
 	}
 
-	if (s->use_committer)
-		author = strdup(got_object_commit_get_committer(commit));
-	else
-		author = strdup(got_object_commit_get_author(commit));
-	if (author == NULL) {
-		err = got_error_from_errno("strdup");
+	err = get_display_author(&author, entry, s->use_committer);
+	if (err)
 		goto done;
-	}
 	err = format_author(&wauthor, &author_width, author, avail - col, col);
 	if (err)
 		goto done;
@@ -2586,15 +2722,9 @@ draw_commit(struct tog_view *view, struct commit_queue_entry *entry,
 	if (col > avail)
 		goto done;
 
-	err = got_object_commit_get_logmsg(&logmsg0, commit);
+	err = get_display_logmsg(&logmsg, entry);
 	if (err)
 		goto done;
-	logmsg = logmsg0;
-	while (*logmsg == '\n')
-		logmsg++;
-	newline = strchr(logmsg, '\n');
-	if (newline)
-		*newline = '\0';
 
 	limit = avail - col;
 	if (view->child && !view_is_hsplit_top(view) && limit > 0)
@@ -2661,18 +2791,15 @@ draw_commit(struct tog_view *view, struct commit_queue_entry *entry,
 		goto done;
 	waddwstr(view->window, &wlogmsg[scrollx]);
 	col += MAX(logmsg_width, 0);
-	while (col < avail) {
-		waddch(view->window, ' ');
-		col++;
+	if (col < avail) {
+		waddblanks(view->window, avail - col);
+		col = avail;
 	}
 done:
-	free(logmsg0);
 	free(wlogmsg);
 	free(wrefstr);
 	free(refs_str);
-	free(author);
 	free(wauthor);
-	free(line);
 	return err;
 }
 
@@ -2681,19 +2808,22 @@ alloc_commit_queue_entry(struct got_commit_object *commit,
     struct got_object_id *id)
 {
 	struct commit_queue_entry *entry;
-	struct got_object_id *dup;
 
 	entry = calloc(1, sizeof(*entry));
 	if (entry == NULL)
 		return NULL;
 
-	dup = got_object_id_dup(id);
-	if (dup == NULL) {
+	memcpy(&entry->id, id, sizeof(entry->id));
+
+	/*
+	 * Cache the hex representation of the ID; the display code
+	 * would otherwise recompute it on every redraw.
+	 */
+	if (got_object_id_str(&entry->id_str, &entry->id)) {
 		free(entry);
 		return NULL;
 	}
 
-	entry->id = dup;
 	entry->commit = commit;
 	return entry;
 }
@@ -2707,7 +2837,10 @@ pop_commit(struct commit_queue *commits)
 	TAILQ_REMOVE(&commits->head, entry, entry);
 	got_object_commit_close(entry->commit);
 	commits->ncommits--;
-	free(entry->id);
+	free(entry->id_str);
+	free(entry->author);
+	free(entry->committer);
+	free(entry->logmsg);
 	free(entry);
 }
 
@@ -2801,7 +2934,7 @@ queue_commits(struct tog_log_thread_args *a)
 				struct commit_queue_entry *matched;
 
 				matched = alloc_commit_queue_entry(
-				    entry->commit, entry->id);
+				    entry->commit, &entry->id);
 				if (matched == NULL) {
 					err = got_error_from_errno(
 					    "alloc_commit_queue_entry");
@@ -2868,32 +3001,25 @@ select_commit(struct tog_log_view_state *s)
 }
 
 static const struct got_error *
-draw_commits(struct tog_view *view)
+draw_log_header(struct tog_view *view)
 {
 	const struct got_error *err = NULL;
 	struct tog_log_view_state *s = &view->state.log;
 	struct commit_queue_entry *entry = s->selected_entry;
-	int limit = view->nlines;
 	int width;
-	int ncommits, author_cols = 4, refstr_cols;
-	char *id_str = NULL, *header = NULL, *ncommits_str = NULL;
+	const char *id_str = NULL;
+	char *header = NULL, *ncommits_str = NULL;
 	char *refs_str = NULL;
 	wchar_t *wline;
 	struct tog_color *tc;
-	static const size_t date_display_cols = 12;
 	struct got_reflist_head *refs;
 
-	if (view_is_hsplit_top(view))
-		--limit;  /* account for border */
-
 	if (s->selected_entry &&
 	    !(view->searching && view->search_next_done == 0)) {
-		err = got_object_id_str(&id_str, s->selected_entry->id);
-		if (err)
-			return err;
+		id_str = s->selected_entry->id_str;
 		refs = got_reflist_object_id_map_lookup(tog_refs_idmap,
-		    s->selected_entry->id);
-		err = build_refs_str(&refs_str, refs, s->selected_entry->id,
+		    &s->selected_entry->id);
+		err = build_refs_str(&refs_str, refs, &s->selected_entry->id,
 		    s->repo);
 		if (err)
 			goto done;
@@ -2957,23 +3083,105 @@ draw_commits(struct tog_view *view)
 	if (err)
 		goto done;
 
-	werase(view->window);
-
+	if (wmove(view->window, 0, 0) == ERR) {
+		free(wline);
+		err = got_error_msg(GOT_ERR_IO, "wmove");
+		goto done;
+	}
 	if (view_needs_focus_indication(view))
 		wstandout(view->window);
 	tc = get_color(&s->colors, TOG_COLOR_COMMIT);
 	if (tc)
 		wattr_on(view->window, COLOR_PAIR(tc->colorpair), NULL);
 	waddwstr(view->window, wline);
-	while (width < view->ncols) {
-		waddch(view->window, ' ');
-		width++;
-	}
+	if (width < view->ncols)
+		waddblanks(view->window, view->ncols - width);
 	if (tc)
 		wattr_off(view->window, COLOR_PAIR(tc->colorpair), NULL);
 	if (view_needs_focus_indication(view))
 		wstandend(view->window);
 	free(wline);
+done:
+	free(refs_str);
+	free(ncommits_str);
+	free(header);
+	return err;
+}
+
+/*
+ * Redraw only the header and the two rows affected by a selection
+ * change. Moving the cursor within the viewport leaves all other rows
+ * untouched, so repainting every visible commit on each key press is
+ * wasted effort.
+ */
+static const struct got_error *
+log_redraw_selection(struct tog_view *view)
+{
+	const struct got_error *err;
+	struct tog_log_view_state *s = &view->state.log;
+	struct commit_queue_entry *entry;
+	static const size_t date_display_cols = 12;
+	int ncommits = 0, limit = view->nlines;
+
+	if (view_is_hsplit_top(view))
+		--limit;  /* account for border */
+
+	err = draw_log_header(view);
+	if (err)
+		return err;
+
+	entry = s->first_displayed_entry;
+	while (entry) {
+		if (ncommits >= limit - 1)
+			break;
+		if (ncommits == s->prev_selected || ncommits == s->selected) {
+			if (wmove(view->window, ncommits + 1, 0) == ERR)
+				return got_error_msg(GOT_ERR_IO, "wmove");
+			wclrtoeol(view->window);
+			if (ncommits == s->selected)
+				wstandout(view->window);
+			err = draw_commit(view, entry, date_display_cols,
+			    s->author_cols);
+			if (ncommits == s->selected)
+				wstandend(view->window);
+			if (err)
+				return err;
+		}
+		ncommits++;
+		entry = TAILQ_NEXT(entry, entry);
+	}
+
+	view_border(view);
+	return NULL;
+}
+
+static const struct got_error *
+draw_commits(struct tog_view *view)
+{
+	const struct got_error *err = NULL;
+	struct tog_log_view_state *s = &view->state.log;
+	struct commit_queue_entry *entry;
+	int limit = view->nlines;
+	int ncommits, author_cols = 4, refstr_cols;
+	char *refs_str = NULL;
+	static const size_t date_display_cols = 12;
+	struct got_reflist_head *refs;
+
+	if (view_is_hsplit_top(view))
+		--limit;  /* account for border */
+
+	if (s->selection_only_redraw) {
+		s->selection_only_redraw = 0;
+		if (!view->searching && s->prev_selected != s->selected)
+			return log_redraw_selection(view);
+	}
+
+	werase(view->window);
+
+	err = draw_log_header(view);
+	if (err)
+		goto done;
+
 	if (limit <= 1)
 		goto done;
 
@@ -2982,31 +3190,24 @@ draw_commits(struct tog_view *view)
 	ncommits = 0;
 	view->maxx = 0;
 	while (entry) {
-		struct got_commit_object *c = entry->commit;
-		char *author, *eol, *msg, *msg0;
+		char *author, *msg;
 		wchar_t *wauthor, *wmsg;
 		int width;
 		if (ncommits >= limit - 1)
 			break;
-		if (s->use_committer)
-			author = strdup(got_object_commit_get_committer(c));
-		else
-			author = strdup(got_object_commit_get_author(c));
-		if (author == NULL) {
-			err = got_error_from_errno("strdup");
+		err = get_display_author(&author, entry, s->use_committer);
+		if (err)
 			goto done;
-		}
 		err = format_author(&wauthor, &width, author, COLS,
 		    date_display_cols);
 		if (author_cols < width)
 			author_cols = width;
 		free(wauthor);
-		free(author);
 		if (err)
 			goto done;
 		refs = got_reflist_object_id_map_lookup(tog_refs_idmap,
-		    entry->id);
-		err = build_refs_str(&refs_str, refs, entry->id, s->repo);
+		    &entry->id);
+		err = build_refs_str(&refs_str, refs, &entry->id, s->repo);
 		if (err)
 			goto done;
 		if (refs_str) {
@@ -3021,20 +3222,14 @@ draw_commits(struct tog_view *view)
 			refstr_cols = width + 3; /* account for [ ] + space */
 		} else
 			refstr_cols = 0;
-		err = got_object_commit_get_logmsg(&msg0, c);
+		err = get_display_logmsg(&msg, entry);
 		if (err)
 			goto done;
-		msg = msg0;
-		while (*msg == '\n')
-			++msg;
-		if ((eol = strchr(msg, '\n')))
-			*eol = '\0';
 		err = format_line(&wmsg, &width, NULL, msg, 0, INT_MAX,
 		    date_display_cols + author_cols + refstr_cols, 0);
 		if (err)
 			goto done;
 		view->maxx = MAX(view->maxx, width + refstr_cols);
-		free(msg0);
 		free(wmsg);
 		ncommits++;
 		entry = TAILQ_NEXT(entry, entry);
@@ -3057,13 +3252,11 @@ draw_commits(struct tog_view *view)
 		s->last_displayed_entry = entry;
 		entry = TAILQ_NEXT(entry, entry);
 	}
+	s->author_cols = author_cols;
 
 	view_border(view);
 done:
-	free(id_str);
 	free(refs_str);
-	free(ncommits_str);
-	free(header);
 	return err;
 }
 
@@ -3111,7 +3304,11 @@ trigger_log_thread(struct tog_view *view, int wait)
 		if (!wait)
 			break;
 
-		/* Display progress update in log view. */
+		/*
+		 * Display a progress update in the log view. The update
+		 * drawn after the previous iteration's wait is still on
+		 * screen, so one full redraw per loaded commit suffices.
+		 */
 		show_log_view(view);
 		update_panels();
 		doupdate();
@@ -3121,11 +3318,6 @@ trigger_log_thread(struct tog_view *view, int wait)
 		if (errcode)
 			return got_error_set_errno(errcode,
 			    "pthread_cond_wait");
-
-		/* Display progress update in log view. */
-		show_log_view(view);
-		update_panels();
-		doupdate();
 	}
 
 	return NULL;
@@ -3169,6 +3361,18 @@ log_scroll_down(struct tog_view *view, int maxscroll)
 		err = trigger_log_thread(view, 1);
 		if (err)
 			return err;
+	} else if (s->commits->ncommits < ncommits_needed + TOG_LOG_PREFETCH &&
+	    !s->thread_args.log_complete) {
+		/*
+		 * The viewport is covered but the queue is running low.
+		 * Request the next batch without waiting for it, so that
+		 * upcoming scrolling does not stall on the log thread.
+		 */
+		s->thread_args.commits_needed +=
+		    ncommits_needed + TOG_LOG_PREFETCH - s->commits->ncommits;
+		err = trigger_log_thread(view, 0);
+		if (err)
+			return err;
 	}
 
 	do {
@@ -3213,7 +3417,7 @@ open_diff_view_for_commit(struct tog_view **new_view, int begin_y, int begin_x,
 
 	if (ls != NULL && ls->marked_entry != NULL &&
 	    ls->marked_entry != ls->selected_entry)
-		parent_id = ls->marked_entry->id;
+		parent_id = &ls->marked_entry->id;
 	else if ((p = STAILQ_FIRST(got_object_commit_get_parent_ids(commit))))
 		parent_id = &p->id;
 	else
@@ -3337,7 +3541,7 @@ browse_commit_tree(struct tog_view **new_view, int begin_y, int begin_x,
 	if (tree_view == NULL)
 		return got_error_from_errno("view_open");
 
-	err = open_tree_view(tree_view, entry->id, head_ref_name, repo);
+	err = open_tree_view(tree_view, &entry->id, head_ref_name, repo);
 	if (err)
 		return err;
 	s = &tree_view->state.tree;
@@ -3693,7 +3897,7 @@ limit_log_view(struct tog_view *view)
 	TAILQ_FOREACH(entry, &s->real_commits.head, entry) {
 		int have_match = 0;
 
-		err = match_commit(&have_match, entry->id,
+		err = match_commit(&have_match, &entry->id,
 		    entry->commit, &s->limit_regex);
 		if (err)
 			return err;
@@ -3702,7 +3906,7 @@ limit_log_view(struct tog_view *view)
 			struct commit_queue_entry *matched;
 
 			matched = alloc_commit_queue_entry(entry->commit,
-			    entry->id);
+			    &entry->id);
 			if (matched == NULL) {
 				err = got_error_from_errno(
 				    "alloc_commit_queue_entry");
@@ -3817,7 +4021,7 @@ search_next_log_view(struct tog_view *view)
 			return trigger_log_thread(view, 0);
 		}
 
-		err = match_commit(&have_match, entry->id, entry->commit,
+		err = match_commit(&have_match, &entry->id, entry->commit,
 		    &view->regex);
 		if (err)
 			break;
@@ -4025,10 +4229,17 @@ log_move_cursor_up(struct tog_view *view, int page, int home)
 	    || home)
 		s->selected = home ? 0 : MAX(0, s->selected - page - 1);
 
-	if (!page && !home && s->selected > 0)
+	if (!page && !home && s->selected > 0) {
+		if (!s->selection_only_redraw) {
+			s->selection_only_redraw = 1;
+			s->prev_selected = s->selected;
+		}
 		--s->selected;
-	else
+	} else {
+		/* The viewport will shift; a full redraw is required. */
+		s->selection_only_redraw = 0;
 		log_scroll_up(s, home ? s->commits->ncommits : MAX(page, 1));
+	}
 
 	select_commit(s);
 	return;
@@ -4052,14 +4263,22 @@ log_move_cursor_down(struct tog_view *view, int page)
 		--eos;  /* border consumes the last line */
 
 	if (!page) {
-		if (s->selected < MIN(eos, s->commits->ncommits - 1))
+		if (s->selected < MIN(eos, s->commits->ncommits - 1)) {
+			if (!s->selection_only_redraw) {
+				s->selection_only_redraw = 1;
+				s->prev_selected = s->selected;
+			}
 			++s->selected;
-		else
+		} else {
+			/* The viewport will shift; force a full redraw. */
+			s->selection_only_redraw = 0;
 			err = log_scroll_down(view, 1);
+		}
 	} else if (s->thread_args.load_all && s->thread_args.log_complete) {
 		struct commit_queue_entry *entry;
 		int n;
 
+		s->selection_only_redraw = 0;
 		s->selected = 0;
 		entry = TAILQ_LAST(&s->commits->head, commit_queue_head);
 		s->last_displayed_entry = entry;
@@ -4072,6 +4291,7 @@ log_move_cursor_down(struct tog_view *view, int page)
 		if (n > 0)
 			s->selected = n - 1;
 	} else {
+		s->selection_only_redraw = 0;
 		if (s->last_displayed_entry->idx == s->commits->ncommits - 1 &&
 		    s->thread_args.log_complete)
 			s->selected += MIN(page,
@@ -4681,11 +4901,19 @@ cmd_log(int argc, char *argv[])
 	}
 
 	if (start_commit == NULL) {
-		error = got_repo_match_object_id(&start_id, &label,
-		    worktree ? got_worktree_get_head_ref_name(worktree) :
-		    GOT_REF_HEAD, GOT_OBJ_TYPE_COMMIT, &tog_refs, repo);
+		const char *ref_name = worktree ?
+		    got_worktree_get_head_ref_name(worktree) : GOT_REF_HEAD;
+
+		error = tog_resolve_cached_ref(&start_id, &label, ref_name,
+		    repo);
 		if (error)
 			goto done;
+		if (start_id == NULL) {
+			error = got_repo_match_object_id(&start_id, &label,
+			    ref_name, GOT_OBJ_TYPE_COMMIT, &tog_refs, repo);
+			if (error)
+				goto done;
+		}
 		head_ref_name = label;
 	} else {
 		error = got_keyword_to_idstr(&keyword_idstr, start_commit,
@@ -5944,11 +6172,11 @@ set_selected_commit(struct tog_diff_view_state *s,
 	struct got_object_qid *pid;
 
 	free(s->id2);
-	s->id2 = got_object_id_dup(entry->id);
+	s->id2 = got_object_id_dup(&entry->id);
 	if (s->id2 == NULL)
 		return got_error_from_errno("got_object_id_dup");
 
-	err = got_object_open_as_commit(&selected_commit, s->repo, entry->id);
+	err = got_object_open_as_commit(&selected_commit, s->repo, &entry->id);
 	if (err)
 		return err;
 	parent_ids = got_object_commit_get_parent_ids(selected_commit);
@@ -9932,7 +10160,7 @@ view_dispatch_request(struct tog_view **new_view, struct tog_view *view,
 			struct tog_log_view_state *s = &view->state.log;
 
 			err = open_diff_view_for_commit(new_view, y, x,
-			    s->selected_entry->commit, s->selected_entry->id,
+			    s->selected_entry->commit, &s->selected_entry->id,
 			    view, s->repo);
 		} else
 			return got_error_msg(GOT_ERR_NOT_IMPL,
@@ -10033,6 +10261,7 @@ offset_selection_up(struct tog_view *view)
 	case TOG_VIEW_LOG:
 		log_scroll_up(&view->state.log, view->offset);
 		view->state.log.selected += view->offset;
+		view->state.log.selection_only_redraw = 0;
 		break;
 	case TOG_VIEW_REF:
 		ref_scroll_up(&view->state.ref, view->offset);
@@ -10360,12 +10589,11 @@ main(int argc, char *argv[])
 		argc = 1;
 		cmd_argv = make_argv(argc, cmd->name);
 	} else {
-		size_t i;
+		size_t i, len = strlen(argv[0]);
 
 		/* Did the user specify a command? */
 		for (i = 0; i < nitems(tog_commands); i++) {
-			if (strncmp(tog_commands[i].name, argv[0],
-			    strlen(argv[0])) == 0) {
+			if (strncmp(tog_commands[i].name, argv[0], len) == 0) {
 				cmd = &tog_commands[i];
 				break;
 			}